@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Protocol.h"
+
+// Sends its arguments to a running compile server and prints the answer,
+// e.g. `client /tmp/compiler.sock --check file.txt`
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "Usage: %s <socket> [compiler options] <file>...\n", argv[0]);
+		return -1;
+	}
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(strlen(argv[1]) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "Socket path %s is too long\n", argv[1]);
+		return -1;
+	}
+	strcpy(address.sun_path, argv[1]);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+		fprintf(stderr, "Cannot connect to %s: %s\n", argv[1], strerror(errno));
+		return -1;
+	}
+
+	char cwd[PATH_MAX];
+	if(getcwd(cwd, sizeof(cwd)) == nullptr) {
+		fprintf(stderr, "Cannot get working directory: %s\n", strerror(errno));
+		return -1;
+	}
+
+	std::vector<std::string> args(argv + 2, argv + argc);
+	std::string response;
+	int status;
+	std::string output;
+
+	if(!Protocol::writeFrame(fd, Protocol::encodeRequest(cwd, args))
+		|| !Protocol::readFrame(fd, response)
+		|| !Protocol::decodeResponse(response, status, output)) {
+		fprintf(stderr, "Lost connection to %s\n", argv[1]);
+		return -1;
+	}
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	close(fd);
+	return status;
+}
@@ -8,6 +8,9 @@ static std::string charColor = Font::byColorCode(200, 120, 40);
 static std::string stringColor = charColor;
 
 static std::string colorize(std::string color, std::string var) {
+	if(!Font::enabled) {
+		return var;
+	}
 	return color + var + Font::reset;
 }
 
@@ -39,6 +42,11 @@ std::string AstFunDecl::toString() const {
 	return "FunDecl[" + name + " : " + type->toString() + (params ? (", " + params->toString()) : "") + (body ? (", " + body->toString()) : "") + "]";
 }
 
+int AstStructDecl::findField(const std::string& field) const {
+	auto it = fieldIndex.find(field);
+	return it == fieldIndex.end() ? -1 : it->second;
+}
+
 std::string AstStructDecl::toString() const {
 	std::string str = "StructDecl[" + name + " : ";
 	for (int i = 0; i < fields.size(); i++) {
@@ -75,6 +83,18 @@ std::string AstType::toString() const {
 	return "AstType";
 }
 
+AstAtomType* AstAtomType::canonical(Type atomType) {
+	static AstAtomType types[] = {
+		AstAtomType(Location(), INT),
+		AstAtomType(Location(), CHAR),
+		AstAtomType(Location(), BOOL),
+		AstAtomType(Location(), VOID),
+		AstAtomType(Location(), FLOAT)
+	};
+
+	return &types[atomType];
+}
+
 std::string AstAtomType::toString() const {
 	std::string ret = "AtomType[";
 	std::string type = getTypeName();
@@ -258,6 +278,20 @@ std::string AstBinaryExpr::toString() const {
 }
 
 
+std::string AstSizeofExpr::toString() const {
+	std::string ret = "AstSizeofExpr";
+	if(ofType) {
+		ret += "{" + ofType->getTypeName() + "}";
+	}
+	ret += "[" + type->toString();
+	if(size >= 0) {
+		ret += ", " + std::to_string(size);
+	}
+	ret += "]";
+	return ret;
+}
+
+
 
 std::string AstStmt::toString() const {
 	return "AstStmt";
@@ -551,6 +585,20 @@ std::string AstBinaryExpr::prettyToString() const {
 }
 
 
+std::string AstSizeofExpr::prettyToString() const {
+	std::string ret = "AstSizeofExpr";
+	if(ofType) {
+		ret += "{" + ofType->prettyGetTypeName() + "}";
+	}
+	ret += "[" + type->prettyToString();
+	if(size >= 0) {
+		ret += ", " + std::to_string(size);
+	}
+	ret += "]";
+	return ret;
+}
+
+
 
 std::string AstStmt::prettyToString() const {
 	return "AstStmt";
@@ -599,3 +647,84 @@ std::string AstVarStmt::prettyToString() const {
 std::string AstFunStmt::prettyToString() const {
 	return "AstFunStmt[" + decl->prettyToString() + "]";
 }
+
+// structEquals()
+
+
+bool AstType::structEquals(const AstType* other) const {
+	if(this == other)
+		return true;
+	if(other == nullptr || type != other->type)
+		return false;
+
+	switch(type) {
+	case AstType::NAMED: return ((AstNamedType*)this)->name == ((AstNamedType*)other)->name;
+	case AstType::PTR: return ((AstPtrType*)this)->ptrType->structEquals(((AstPtrType*)other)->ptrType);
+	case AstType::ARRAY:
+		return ((AstArrayType*)this)->arrayType->structEquals(((AstArrayType*)other)->arrayType)
+			&& ((AstArrayType*)this)->expr->structEquals(((AstArrayType*)other)->expr);
+	default:
+		return true;
+	}
+}
+
+bool AstConstExpr::structEquals(const AstExpr* other) const {
+	const AstConstExpr* expr = dynamic_cast<const AstConstExpr*>(other);
+	if(expr == nullptr || hash != expr->hash || type != expr->type)
+		return false;
+
+	switch(type) {
+		case Token::NUMBER: return ivalue == expr->ivalue;
+		case Token::CHARACTER: return cvalue == expr->cvalue;
+		case Token::FNUMBER: return fvalue == expr->fvalue;
+		case Token::STRING: return str == expr->str;
+		default: return true;
+	}
+}
+
+bool AstNamedExpr::structEquals(const AstExpr* other) const {
+	const AstNamedExpr* expr = dynamic_cast<const AstNamedExpr*>(other);
+	return expr && hash == expr->hash && declaration == expr->declaration && name == expr->name;
+}
+
+bool AstCallExpr::structEquals(const AstExpr* other) const {
+	const AstCallExpr* expr = dynamic_cast<const AstCallExpr*>(other);
+	if(expr == nullptr || hash != expr->hash || declaration != expr->declaration || args.size() != expr->args.size())
+		return false;
+
+	for(int i = 0; i < args.size(); i++) {
+		if(!args[i]->structEquals(expr->args[i]))
+			return false;
+	}
+	return true;
+}
+
+bool AstCastExpr::structEquals(const AstExpr* other) const {
+	const AstCastExpr* expr = dynamic_cast<const AstCastExpr*>(other);
+	return expr && hash == expr->hash && type->structEquals(expr->type) && this->expr->structEquals(expr->expr);
+}
+
+bool AstPrefixExpr::structEquals(const AstExpr* other) const {
+	const AstPrefixExpr* expr = dynamic_cast<const AstPrefixExpr*>(other);
+	return expr && hash == expr->hash && op == expr->op && this->expr->structEquals(expr->expr);
+}
+
+bool AstPostfixExpr::structEquals(const AstExpr* other) const {
+	const AstPostfixExpr* expr = dynamic_cast<const AstPostfixExpr*>(other);
+	if(expr == nullptr || hash != expr->hash || op != expr->op || name != expr->name)
+		return false;
+	if(index && !index->structEquals(expr->index))
+		return false;
+
+	return this->expr->structEquals(expr->expr);
+}
+
+bool AstBinaryExpr::structEquals(const AstExpr* other) const {
+	const AstBinaryExpr* expr = dynamic_cast<const AstBinaryExpr*>(other);
+	return expr && hash == expr->hash && op == expr->op && left->structEquals(expr->left) && right->structEquals(expr->right);
+}
+
+bool AstSizeofExpr::structEquals(const AstExpr* other) const {
+	const AstSizeofExpr* expr = dynamic_cast<const AstSizeofExpr*>(other);
+	return expr && hash == expr->hash && type->structEquals(expr->type);
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 #include "Token.h"
 #include "Visitor.h"
@@ -32,6 +33,7 @@ public:
 	virtual std::string prettyToString() const override;
 
 	virtual AstType* getType() {}
+	virtual const char* getName() const { return ""; }
 };
 
 class AstVarDecl : public AstDecl {
@@ -42,6 +44,7 @@ public:
 	
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	const char* getName() const override { return name.c_str(); }
 public:
 	AstType* type = nullptr;
 	AstExpr* expr = nullptr;
@@ -70,6 +73,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	const char* getName() const override { return name.c_str(); }
 public:
 	std::string name;
 	AstType* type;
@@ -86,6 +90,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	const char* getName() const override { return name.c_str(); }
 public:
 	AstType* type = nullptr;
 	std::string name;
@@ -99,9 +104,19 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	const char* getName() const override { return name.c_str(); }
+	int findField(const std::string& field) const; // index into fields or -1
 public:
 	std::string name;
 	std::vector<AstVarDecl> fields;
+
+	// layout, computed once by Layout::layoutStruct
+	int size = -1;
+	int align = 1;
+	std::vector<int> offsets;
+	std::unordered_map<std::string, int> fieldIndex;
+	bool layingOut = false;
+	bool layoutFailed = false;		// already reported, later lookups fail right away
 };
 
 /* ----- TYPES ----- */
@@ -125,12 +140,17 @@ public:
 	virtual std::string prettyToString() const override;
 	std::string getTypeName() const;
 	std::string prettyGetTypeName() const;
+
+	bool structEquals(const AstType* other) const;
 };
 
 class AstAtomType : public AstType {
 public:
 	AstAtomType(Location location, Type atomType) { type = atomType; loc = location; }
 
+	// shared instance for INT, CHAR, BOOL, VOID and FLOAT, must not be modified
+	static AstAtomType* canonical(Type atomType);
+
 	bool accept(Visitor* visitor, Phase phase) override { return visitor->visit(this, phase); }
 
 	std::string toString() const override;
@@ -174,6 +194,7 @@ public:
 public:
 	AstType* arrayType;
 	AstExpr* expr;
+	int size = -1;	// number of elements, known after type resolution
 };
 
 /* ----- EXPRS ----- */
@@ -183,8 +204,12 @@ public:
 	virtual std::string toString() const override;
 	virtual std::string prettyToString() const override;
 
+	// structural equality, hash must be computed first (see ExprHasher)
+	virtual bool structEquals(const AstExpr* other) const = 0;
+
 	AstType* ofType = nullptr;
 	bool isLValue = false;
+	size_t hash = 0;
 };
 
 class AstConstExpr : public AstExpr {
@@ -199,6 +224,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	Token::TokenType type;
 	union {
@@ -218,6 +244,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	std::string name;
 	AstDecl* declaration = nullptr;
@@ -231,6 +258,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	std::string name;
 	std::vector<AstExpr*> args;
@@ -245,6 +273,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	AstType* type;
 	AstExpr* expr;
@@ -269,6 +298,7 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	Prefix op;
 	AstExpr* expr;
@@ -292,12 +322,14 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	int type = 0;
 	AstExpr* expr = nullptr;
 	AstExpr* index = nullptr;
 	Postfix op;
 	std::string name = "";
+	int field = -1;	// index of the accessed struct field
 };
 
 class AstBinaryExpr : public AstExpr {
@@ -327,12 +359,27 @@ public:
 
 	std::string toString() const override;
 	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
 public:
 	AstExpr* left;
 	Binary op;
 	AstExpr* right;
 };
 
+class AstSizeofExpr : public AstExpr {
+public:
+	AstSizeofExpr(Location location, AstType* type) : type(type) { loc = location; }
+
+	bool accept(Visitor* visitor, Phase phase) override { return visitor->visit(this, phase); }
+
+	std::string toString() const override;
+	std::string prettyToString() const override;
+	bool structEquals(const AstExpr* other) const override;
+public:
+	AstType* type;
+	int size = -1;	// known after type resolution
+};
+
 // class AstNewExpr : public AstExpr {
 // public:
 // 	AstNewExpr(Location location, AstType* type) : type(type) { loc = location; }
@@ -0,0 +1,508 @@
+#include "ConstFolder.h"
+#include "Layout.h"
+#include "OperatorTable.h"
+#include <climits>
+#include <cmath>
+
+static bool isIntegral(const ConstValue& value) {
+	return value.type == AstType::INT || value.type == AstType::CHAR;
+}
+
+static int toInt(const ConstValue& value) {
+	switch(value.type) {
+		case AstType::CHAR: return value.cvalue;
+		case AstType::BOOL: return value.bvalue;
+		default: return value.ivalue;
+	}
+}
+
+static double toDouble(const ConstValue& value) {
+	return value.type == AstType::FLOAT ? value.fvalue : toInt(value);
+}
+
+// int arithmetic wraps around instead of invoking undefined behaviour,
+// division by zero is left for the runtime
+static bool evalIntArith(AstBinaryExpr::Binary op, int a, int b, int& result) {
+	unsigned ua = a, ub = b;
+
+	switch(op) {
+		case AstBinaryExpr::PLUS: result = (int)(ua + ub); return true;
+		case AstBinaryExpr::MINUS: result = (int)(ua - ub); return true;
+		case AstBinaryExpr::MUL: result = (int)(ua * ub); return true;
+		case AstBinaryExpr::DIV:
+		case AstBinaryExpr::MOD:
+			if(b == 0 || (a == INT_MIN && b == -1)) {
+				return false;
+			}
+			result = (op == AstBinaryExpr::DIV) ? a / b : a % b;
+			return true;
+		default: return false;
+	}
+}
+
+static bool evalBinary(AstBinaryExpr::Binary op, const ConstValue& left, const ConstValue& right, ConstValue& result) {
+	OperatorResult kind = OperatorTable::binaryResult(op, left.type, right.type);
+	if(kind == OperatorResult::INVALID) {
+		return false;
+	}
+
+	switch(op) {
+		case AstBinaryExpr::PLUS:
+		case AstBinaryExpr::MINUS:
+		case AstBinaryExpr::MUL:
+		case AstBinaryExpr::DIV:
+		case AstBinaryExpr::MOD:
+			if(left.type == AstType::FLOAT) {
+				if(op == AstBinaryExpr::MOD || (op == AstBinaryExpr::DIV && right.fvalue == 0)) {
+					return false;
+				}
+
+				result.type = AstType::FLOAT;
+				switch(op) {
+					case AstBinaryExpr::PLUS: result.fvalue = left.fvalue + right.fvalue; break;
+					case AstBinaryExpr::MINUS: result.fvalue = left.fvalue - right.fvalue; break;
+					case AstBinaryExpr::MUL: result.fvalue = left.fvalue * right.fvalue; break;
+					default: result.fvalue = left.fvalue / right.fvalue; break;
+				}
+				return true;
+			}
+			// int op int, char op int and int op char, chars are promoted first
+			else if(isIntegral(left) && isIntegral(right)) {
+				int value;
+				if(!evalIntArith(op, toInt(left), toInt(right), value)) {
+					return false;
+				}
+
+				result.type = (kind == OperatorResult::LEFT) ? left.type : right.type;
+				if(result.type == AstType::CHAR) {
+					result.cvalue = (char)value;
+				}
+				else {
+					result.ivalue = value;
+				}
+				return true;
+			}
+			return false;
+		case AstBinaryExpr::EQU:
+		case AstBinaryExpr::NEQ:
+		case AstBinaryExpr::LESS:
+		case AstBinaryExpr::LESS_EQU:
+		case AstBinaryExpr::GREATER:
+		case AstBinaryExpr::GREATER_EQU: {
+			// every int and char is exactly representable as a double
+			double a = toDouble(left);
+			double b = toDouble(right);
+
+			result.type = AstType::BOOL;
+			switch(op) {
+				case AstBinaryExpr::EQU: result.bvalue = a == b; break;
+				case AstBinaryExpr::NEQ: result.bvalue = a != b; break;
+				case AstBinaryExpr::LESS: result.bvalue = a < b; break;
+				case AstBinaryExpr::LESS_EQU: result.bvalue = a <= b; break;
+				case AstBinaryExpr::GREATER: result.bvalue = a > b; break;
+				default: result.bvalue = a >= b; break;
+			}
+			return true;
+		}
+		case AstBinaryExpr::AND:
+		case AstBinaryExpr::OR:
+		case AstBinaryExpr::XOR:
+			result.type = AstType::INT;
+			switch(op) {
+				case AstBinaryExpr::AND: result.ivalue = left.ivalue & right.ivalue; break;
+				case AstBinaryExpr::OR: result.ivalue = left.ivalue | right.ivalue; break;
+				default: result.ivalue = left.ivalue ^ right.ivalue; break;
+			}
+			return true;
+		case AstBinaryExpr::ANDAND:
+		case AstBinaryExpr::OROR:
+			result.type = AstType::BOOL;
+			result.bvalue = (op == AstBinaryExpr::ANDAND) ? (left.bvalue && right.bvalue) : (left.bvalue || right.bvalue);
+			return true;
+	}
+
+	return false;
+}
+
+static bool evalPrefix(AstPrefixExpr::Prefix op, const ConstValue& operand, ConstValue& result) {
+	switch(op) {
+		case AstPrefixExpr::PLUS:
+			if(operand.type != AstType::INT && operand.type != AstType::FLOAT) {
+				return false;
+			}
+			result = operand;
+			return true;
+		case AstPrefixExpr::MINUS:
+			if(operand.type == AstType::INT) {
+				result.type = AstType::INT;
+				result.ivalue = (int)(0u - (unsigned)operand.ivalue);
+				return true;
+			}
+			else if(operand.type == AstType::FLOAT) {
+				result.type = AstType::FLOAT;
+				result.fvalue = -operand.fvalue;
+				return true;
+			}
+			return false;
+		case AstPrefixExpr::NOT:
+			if(operand.type != AstType::BOOL) {
+				return false;
+			}
+			result.type = AstType::BOOL;
+			result.bvalue = !operand.bvalue;
+			return true;
+		case AstPrefixExpr::NEGATE:
+			if(operand.type != AstType::INT) {
+				return false;
+			}
+			result.type = AstType::INT;
+			result.ivalue = ~operand.ivalue;
+			return true;
+		default:
+			// ++, --, * and & need an lvalue
+			return false;
+	}
+}
+
+static bool evalCast(AstType::Type type, const ConstValue& operand, ConstValue& result) {
+	double value = toDouble(operand);
+
+	switch(type) {
+		case AstType::INT:
+			// float to int conversion is undefined outside the int range
+			if(!std::isfinite(value) || value <= (double)INT_MIN - 1 || value >= (double)INT_MAX + 1) {
+				return false;
+			}
+			result.ivalue = (int)value;
+			break;
+		case AstType::CHAR:
+			if(operand.type == AstType::FLOAT && (!std::isfinite(value) || value <= CHAR_MIN - 1 || value >= CHAR_MAX + 1)) {
+				return false;
+			}
+			result.cvalue = (operand.type == AstType::FLOAT) ? (char)value : (char)toInt(operand);
+			break;
+		case AstType::BOOL:
+			result.bvalue = value != 0;
+			break;
+		case AstType::FLOAT:
+			result.fvalue = (operand.type == AstType::FLOAT) ? operand.fvalue : (float)toInt(operand);
+			break;
+		default:
+			return false;
+	}
+
+	result.type = type;
+	return true;
+}
+
+
+
+bool ConstFolder::evaluate(AstExpr* expr, ConstValue& value) {
+	ConstFolder folder;
+	expr->accept(&folder, Phase::BODY);
+
+	value = folder.value;
+	return folder.known;
+}
+
+bool ConstFolder::fold(AstExpr*& expr, Phase phase) {
+	if(!expr->accept(this, phase)) {
+		return false;
+	}
+
+	if(known) {
+		materialize(expr, value);
+		known = false;
+	}
+
+	return true;
+}
+
+void ConstFolder::materialize(AstExpr*& expr, const ConstValue& constValue) {
+	if(exprs == nullptr || dynamic_cast<AstConstExpr*>(expr) != nullptr) {
+		return;
+	}
+
+	AstConstExpr* constExpr;
+	switch(constValue.type) {
+		case AstType::CHAR: constExpr = new AstConstExpr(expr->loc, constValue.cvalue); break;
+		case AstType::BOOL: constExpr = new AstConstExpr(expr->loc, constValue.bvalue); break;
+		case AstType::FLOAT: constExpr = new AstConstExpr(expr->loc, constValue.fvalue); break;
+		default: constExpr = new AstConstExpr(expr->loc, constValue.ivalue); break;
+	}
+
+	// the folded node keeps the type the resolver gave the whole subtree
+	constExpr->ofType = expr->ofType;
+	exprs->push_back(constExpr);
+
+	expr = constExpr;
+	folded++;
+}
+
+
+
+bool ConstFolder::visit(AstVarDecl* varDecl, Phase phase) {
+	if(!varDecl->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(varDecl->expr && !fold(varDecl->expr, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstParDecl* parDecl, Phase phase) {
+	for(AstVarDecl& decl : parDecl->params) {
+		if(!decl.accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstFunDecl* funDecl, Phase phase) {
+	if(!funDecl->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(funDecl->params && !funDecl->params->accept(this, phase)) {
+		return false;
+	}
+
+	if(funDecl->body && !funDecl->body->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstTypeDecl* typeDecl, Phase phase) {
+	return typeDecl->type->accept(this, phase);
+}
+
+bool ConstFolder::visit(AstStructDecl* structDecl, Phase phase) {
+	for(AstVarDecl& decl : structDecl->fields) {
+		if(!decl.accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+bool ConstFolder::visit(AstAtomType* atomType, Phase phase) {
+	return true;
+}
+
+bool ConstFolder::visit(AstNamedType* namedType, Phase phase) {
+	return true;
+}
+
+bool ConstFolder::visit(AstPtrType* ptrType, Phase phase) {
+	return ptrType->ptrType->accept(this, phase);
+}
+
+bool ConstFolder::visit(AstArrayType* arrayType, Phase phase) {
+	if(!arrayType->arrayType->accept(this, phase)) {
+		return false;
+	}
+
+	return fold(arrayType->expr, phase);
+}
+
+
+
+bool ConstFolder::visit(AstConstExpr* constExpr, Phase phase) {
+	known = true;
+
+	switch(constExpr->type) {
+		case Token::NUMBER: value.type = AstType::INT; value.ivalue = constExpr->ivalue; break;
+		case Token::CHARACTER: value.type = AstType::CHAR; value.cvalue = constExpr->cvalue; break;
+		case Token::TRUE:
+		case Token::FALSE: value.type = AstType::BOOL; value.bvalue = constExpr->bvalue; break;
+		case Token::FNUMBER: value.type = AstType::FLOAT; value.fvalue = constExpr->fvalue; break;
+		default: known = false; break;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstNamedExpr* namedExpr, Phase phase) {
+	known = false;
+	return true;
+}
+
+bool ConstFolder::visit(AstCallExpr* callExpr, Phase phase) {
+	for(AstExpr*& expr : callExpr->args) {
+		if(!fold(expr, phase)) {
+			return false;
+		}
+	}
+
+	known = false;
+	return true;
+}
+
+bool ConstFolder::visit(AstCastExpr* castExpr, Phase phase) {
+	if(!castExpr->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(!castExpr->expr->accept(this, phase)) {
+		return false;
+	}
+
+	ConstValue operand = value;
+	if(known && !evalCast(castExpr->type->type, operand, value)) {
+		materialize(castExpr->expr, operand);
+		known = false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstPrefixExpr* prefixExpr, Phase phase) {
+	if(!prefixExpr->expr->accept(this, phase)) {
+		return false;
+	}
+
+	ConstValue operand = value;
+	if(known && !evalPrefix(prefixExpr->op, operand, value)) {
+		materialize(prefixExpr->expr, operand);
+		known = false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstPostfixExpr* postfixExpr, Phase phase) {
+	if(!fold(postfixExpr->expr, phase)) {
+		return false;
+	}
+
+	if(postfixExpr->index && !fold(postfixExpr->index, phase)) {
+		return false;
+	}
+
+	known = false;
+	return true;
+}
+
+bool ConstFolder::visit(AstBinaryExpr* binaryExpr, Phase phase) {
+	if(!binaryExpr->left->accept(this, phase)) {
+		return false;
+	}
+
+	bool leftKnown = known;
+	ConstValue left = value;
+
+	if(!binaryExpr->right->accept(this, phase)) {
+		return false;
+	}
+
+	bool rightKnown = known;
+	ConstValue right = value;
+
+	known = leftKnown && rightKnown && evalBinary(binaryExpr->op, left, right, value);
+
+	// the right side of a short-circuited && or || is never evaluated
+	if(!known && leftKnown && left.type == AstType::BOOL) {
+		if((binaryExpr->op == AstBinaryExpr::ANDAND && !left.bvalue) || (binaryExpr->op == AstBinaryExpr::OROR && left.bvalue)) {
+			known = true;
+			value = left;
+		}
+	}
+
+	if(!known) {
+		if(leftKnown) {
+			materialize(binaryExpr->left, left);
+		}
+		if(rightKnown) {
+			materialize(binaryExpr->right, right);
+		}
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstSizeofExpr* sizeofExpr, Phase phase) {
+	if(!sizeofExpr->type->accept(this, phase)) {
+		return false;
+	}
+
+	int size = (sizeofExpr->size >= 0) ? sizeofExpr->size : Layout::sizeOf(sizeofExpr->type);
+
+	known = size >= 0;
+	value.type = AstType::INT;
+	value.ivalue = size;
+	return true;
+}
+
+
+
+bool ConstFolder::visit(AstExprStmt* exprStmt, Phase phase) {
+	return fold(exprStmt->expr, phase);
+}
+
+bool ConstFolder::visit(AstAssignStmt* assignStmt, Phase phase) {
+	if(!fold(assignStmt->left, phase)) {
+		return false;
+	}
+
+	return fold(assignStmt->right, phase);
+}
+
+bool ConstFolder::visit(AstCompStmt* compStmt, Phase phase) {
+	for(AstStmt* stmt : compStmt->stmts) {
+		if(!stmt->accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstIfStmt* ifStmt, Phase phase) {
+	if(!fold(ifStmt->cond, phase)) {
+		return false;
+	}
+
+	if(!ifStmt->stmt->accept(this, phase)) {
+		return false;
+	}
+
+	if(ifStmt->elseStmt && !ifStmt->elseStmt->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstWhileStmt* whileStmt, Phase phase) {
+	if(!fold(whileStmt->cond, phase)) {
+		return false;
+	}
+
+	return whileStmt->stmt->accept(this, phase);
+}
+
+bool ConstFolder::visit(AstReturnStmt* returnStmt, Phase phase) {
+	if(returnStmt->expr && !fold(returnStmt->expr, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ConstFolder::visit(AstVarStmt* varStmt, Phase phase) {
+	return varStmt->decl.accept(this, phase);
+}
+
+bool ConstFolder::visit(AstFunStmt* funStmt, Phase phase) {
+	return funStmt->decl->accept(this, phase);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include "Visitor.h"
+#include "Ast.h"
+
+// value of a compile-time constant, type is one of INT, CHAR, BOOL, FLOAT
+struct ConstValue {
+	AstType::Type type;
+	union {
+		int ivalue;
+		char cvalue;
+		bool bvalue;
+		float fvalue;
+	};
+};
+
+// Evaluates constant expressions with C-like int/char/bool/float semantics.
+// When given the expression list of the parser, every maximal constant subtree
+// is replaced in place by a single AstConstExpr owned by that list.
+class ConstFolder : public Visitor {
+private:
+	std::vector<AstExpr*>* exprs;	// nullptr: evaluate only, don't fold
+	bool known = false;				// was the last visited expression constant
+	ConstValue value;
+	int folded = 0;
+
+	bool fold(AstExpr*& expr, Phase phase);
+	void materialize(AstExpr*& expr, const ConstValue& constValue);
+
+public:
+	ConstFolder(std::vector<AstExpr*>* exprs = nullptr) : exprs(exprs) {}
+
+	// evaluates expr without modifying the tree, false if it isn't constant
+	static bool evaluate(AstExpr* expr, ConstValue& value);
+
+	int getFolded() const { return folded; }
+
+	bool visit(AstVarDecl* varDecl, Phase phase) override;
+	bool visit(AstParDecl* parDecl, Phase phase) override;
+	bool visit(AstFunDecl* funDecl, Phase phase) override;
+	bool visit(AstTypeDecl* typeDecl, Phase phase) override;
+	bool visit(AstStructDecl* structDecl, Phase phase) override;
+
+	bool visit(AstAtomType* atomType, Phase phase) override;
+	bool visit(AstNamedType* namedType, Phase phase) override;
+	bool visit(AstPtrType* ptrType, Phase phase) override;
+	bool visit(AstArrayType* arrayType, Phase phase) override;
+
+	bool visit(AstConstExpr* constExpr, Phase phase) override;
+	bool visit(AstNamedExpr* namedExpr, Phase phase) override;
+	bool visit(AstCallExpr* callExpr, Phase phase) override;
+	bool visit(AstCastExpr* castExpr, Phase phase) override;
+	bool visit(AstPrefixExpr* prefixExpr, Phase phase) override;
+	bool visit(AstPostfixExpr* postfixExpr, Phase phase) override;
+	bool visit(AstBinaryExpr* binaryExpr, Phase phase) override;
+	bool visit(AstSizeofExpr* sizeofExpr, Phase phase) override;
+
+	bool visit(AstExprStmt* exprStmt, Phase phase) override;
+	bool visit(AstAssignStmt* assignStmt, Phase phase) override;
+	bool visit(AstCompStmt* compStmt, Phase phase) override;
+	bool visit(AstIfStmt* ifStmt, Phase phase) override;
+	bool visit(AstWhileStmt* whileStmt, Phase phase) override;
+	bool visit(AstReturnStmt* returnStmt, Phase phase) override;
+	bool visit(AstVarStmt* varStmt, Phase phase) override;
+	bool visit(AstFunStmt* funStmt, Phase phase) override;
+};
@@ -0,0 +1,146 @@
+#include "Diagnostics.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include "Logger.h"
+
+thread_local Diagnostics* Diagnostics::current = nullptr;
+
+Diagnostics* Diagnostics::collect(Diagnostics* diagnostics) {
+	Diagnostics* previous = current;
+	current = diagnostics;
+	return previous;
+}
+
+void Diagnostics::report(Diagnostic&& diagnostic) {
+	if(current == nullptr) {
+		Logger::getInstance().write(header("", diagnostic) + "\n");
+		return;
+	}
+
+	if(diagnostic.severity == ERROR) {
+		current->errors++;
+	}
+	current->records.push_back(std::move(diagnostic));
+}
+
+void Diagnostics::merge(Diagnostics& other) {
+	records.insert(records.end(), std::make_move_iterator(other.records.begin()), std::make_move_iterator(other.records.end()));
+	errors += other.errors;
+
+	other.records.clear();
+	other.errors = 0;
+}
+
+std::string Diagnostics::message(const Diagnostic& diagnostic) {
+	std::string text;
+	size_t arg = 0;
+
+	for(const char* c = diagnostic.format; *c; c++) {
+		if(c[0] == '%' && c[1] == 's' && arg < diagnostic.args.size()) {
+			text += diagnostic.args[arg++];
+			c++;
+		}
+		else {
+			text += *c;
+		}
+	}
+
+	return text;
+}
+
+std::string Diagnostics::header(const std::string& path, const Diagnostic& diagnostic) {
+	static const char* names[] = { "error", "warning", "note" };
+	static const std::string* colors[] = { &Font::fred, &Font::fmagenta, &Font::fcyan };
+
+	std::string where = path.empty() ? "" : path + ":";
+	where += std::to_string(diagnostic.loc.line) + ":" + std::to_string(diagnostic.loc.start + 1) + ": ";
+	std::string kind = std::string(names[diagnostic.severity]) + "[" + diagnostic.code + "]";
+
+	if(!Font::enabled) {
+		return where + kind + ": " + message(diagnostic);
+	}
+	return Font::bold + where + *colors[diagnostic.severity] + kind + Font::reset + Font::bold + ": " + message(diagnostic) + Font::reset;
+}
+
+std::string Diagnostics::snippet(const std::string& line, const Location& loc) {
+	std::string number = std::to_string(loc.line);
+	number.insert(0, number.size() < 5 ? 5 - number.size() : 0, ' ');
+
+	std::string text = number + " | " + line + "\n";
+	text += std::string(number.size(), ' ') + " | ";
+
+	// keep tabs, so the marker lines up with the source above it
+	int start = std::min(loc.start, (int)line.size());
+	for(int i = 0; i < start; i++) {
+		text += line[i] == '\t' ? '\t' : ' ';
+	}
+
+	// the end may lie on a later line, then only the start is marked
+	int end = (loc.end > start && loc.end < (int)line.size()) ? loc.end : start;
+	std::string marker = "^" + std::string(end - start, '~');
+
+	text += Font::enabled ? Font::fgreen + marker + Font::reset : marker;
+	return text + "\n";
+}
+
+void Diagnostics::print(const std::string& path, size_t limit, const std::string* source) {
+	if(records.empty()) {
+		return;
+	}
+
+	// sorted by everything that tells them apart, so duplicates end up next to each other
+	std::stable_sort(records.begin(), records.end(), [](const Diagnostic& a, const Diagnostic& b) {
+		if(a.loc.line != b.loc.line) return a.loc.line < b.loc.line;
+		if(a.loc.start != b.loc.start) return a.loc.start < b.loc.start;
+		if(a.severity != b.severity) return a.severity < b.severity;
+
+		int format = strcmp(a.format, b.format);
+		if(format != 0) return format < 0;
+		return a.args < b.args;
+	});
+
+	// e.g. a struct that contains itself is found again through every access to it
+	auto same = [](const Diagnostic& a, const Diagnostic& b) {
+		return a.loc.line == b.loc.line && a.loc.start == b.loc.start && a.severity == b.severity
+			&& strcmp(a.format, b.format) == 0 && a.args == b.args;
+	};
+	records.erase(std::unique(records.begin(), records.end(), same), records.end());
+
+	// sources are only read back when there is something to show
+	std::string content;
+	if(source == nullptr) {
+		std::ifstream file(path);
+		std::ostringstream stream;
+		stream << file.rdbuf();
+		content = stream.str();
+		source = &content;
+	}
+
+	std::vector<std::string> lines;
+	std::istringstream input(*source);
+	for(std::string line; std::getline(input, line);) {
+		lines.push_back(line);
+	}
+
+	size_t shown = (limit == 0) ? records.size() : std::min(limit, records.size());
+	std::string text;
+
+	for(size_t i = 0; i < shown; i++) {
+		const Diagnostic& diagnostic = records[i];
+		text += header(path, diagnostic) + "\n";
+
+		if(diagnostic.loc.line > 0 && diagnostic.loc.line <= (int)lines.size()) {
+			text += snippet(lines[diagnostic.loc.line - 1], diagnostic.loc);
+		}
+	}
+
+	if(shown < records.size()) {
+		text += path + ": " + std::to_string(records.size() - shown) + " more diagnostics not shown\n";
+	}
+
+	Logger::getInstance().write(text);
+	records.clear();
+	errors = 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Location.h"
+
+// Source diagnostics of one input. Reporting only stores the code, location, format and
+// arguments, the text is rendered once the input is done: sorted by location, without
+// duplicates and with the offending source line. Every thread reports into the collector
+// it installed with collect(), so parallel tasks each fill their own and merge afterwards.
+//
+// Codes start with the phase that reports them: L lexical, S syntax, N names, T types.
+class Diagnostics {
+public:
+	enum Severity {
+		ERROR,
+		WARNING,
+		NOTE
+	};
+
+	struct Diagnostic {
+		Severity severity;
+		const char* code;
+		Location loc;
+		const char* format;		// only %s, one per argument
+		std::vector<std::string> args;
+	};
+
+private:
+	static thread_local Diagnostics* current;
+
+	std::vector<Diagnostic> records;
+	size_t errors = 0;
+
+	static std::string argument(const std::string& arg) { return arg; }
+	static std::string argument(const char* arg) { return arg; }
+
+	template<typename T>
+	static std::string argument(T arg) { return std::to_string(arg); }
+
+	static void report(Diagnostic&& diagnostic);
+	static std::string message(const Diagnostic& diagnostic);
+	static std::string header(const std::string& path, const Diagnostic& diagnostic);
+	static std::string snippet(const std::string& line, const Location& loc);
+
+public:
+	// reports of this thread go to diagnostics (nullptr prints them right away), returns the previous collector
+	static Diagnostics* collect(Diagnostics* diagnostics);
+	static Diagnostics* collector() { return current; }
+
+	template<typename... Args>
+	static void error(const char* code, const Location& loc, const char* format, Args... args) {
+		report({ ERROR, code, loc, format, { argument(args)... } });
+	}
+
+	template<typename... Args>
+	static void warning(const char* code, const Location& loc, const char* format, Args... args) {
+		report({ WARNING, code, loc, format, { argument(args)... } });
+	}
+
+	template<typename... Args>
+	static void note(const char* code, const Location& loc, const char* format, Args... args) {
+		report({ NOTE, code, loc, format, { argument(args)... } });
+	}
+
+	void merge(Diagnostics& other);		// moves the records of other into this one
+	size_t getErrorCount() const { return errors; }
+	bool empty() const { return records.empty(); }
+
+	// renders everything reported for path through the Logger, at most limit records (0: all),
+	// quoting source if given and the file read back otherwise
+	void print(const std::string& path, size_t limit, const std::string* source = nullptr);
+};
@@ -0,0 +1,190 @@
+#include "DiskCache.h"
+#include "Driver.h"
+#include "Hash.h"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+// every build of the compiler gets its own entries, the Makefile passes a hash of the
+// sources and itself; the fallback only changes when this file is compiled again
+#ifndef BUILD_ID
+#define BUILD_ID __DATE__ " " __TIME__
+#endif
+static const char MAGIC[4] = { 'C', 'C', 'H', '1' };
+
+static std::string toHex(uint64_t value) {
+	char text[17];
+	snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+	return text;
+}
+
+static void putString(std::string& out, const std::string& value) {
+	uint64_t size = value.size();
+	out.append((const char*)&size, sizeof(size));
+	out += value;
+}
+
+static bool getString(const std::string& in, size_t& pos, std::string& value) {
+	uint64_t size;
+	if(pos + sizeof(size) > in.size()) {
+		return false;
+	}
+
+	memcpy(&size, &in[pos], sizeof(size));
+	pos += sizeof(size);
+
+	if(size > in.size() - pos) {
+		return false;
+	}
+
+	value = in.substr(pos, size);
+	pos += size;
+	return true;
+}
+
+static bool readFile(const std::string& path, std::string& content) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file) {
+		return false;
+	}
+
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	content = stream.str();
+	return true;
+}
+
+bool DiskCache::open() {
+	std::error_code error;
+	fs::create_directories(dir, error);
+	return fs::is_directory(dir, error);
+}
+
+std::string DiskCache::entryPath(const std::string& key) const {
+	return dir + "/" + toHex(xxhash64(key)) + ".cache";
+}
+
+bool DiskCache::makeKey(const std::string& path, const Options& options, std::string& source, std::string& key) const {
+	if(!readFile(path, source)) {
+		return false;
+	}
+
+	key = toHex(xxhash64(source, xxhash64(BUILD_ID, strlen(BUILD_ID))));
+	key += '\0' + std::to_string((int)options.stopAfter);
+	key += options.dumpTokens ? 't' : '-';
+	key += options.dumpAst ? 'a' : '-';
+	key += options.dumpIr ? 'i' : '-';
+	key += options.optimize ? 'O' : '-';
+	key += options.optReport ? 'r' : '-';
+	key += options.check ? 'c' : '-';
+	key += options.output.empty() ? '-' : 'o';
+	key += options.color ? 'C' : '-';
+	key += options.debug ? 'd' : '-';
+	key += '\0' + std::to_string(options.maxErrors);
+	key += '\0' + path;		// diagnostics name the file
+	return true;
+}
+
+bool DiskCache::find(const std::string& key, ResultCache::Entry& entry) {
+	std::string path = entryPath(key);
+	std::string content;
+	std::string storedKey;
+	size_t pos = sizeof(MAGIC) + 1;
+
+	bool found = readFile(path, content)
+		&& content.size() > sizeof(MAGIC)
+		&& memcmp(content.data(), MAGIC, sizeof(MAGIC)) == 0
+		&& getString(content, pos, storedKey) && storedKey == key
+		&& getString(content, pos, entry.log)
+		&& getString(content, pos, entry.dumps);
+
+	if(!found) {
+		stats.misses++;
+		return false;
+	}
+
+	entry.success = content[sizeof(MAGIC)] != 0;
+
+	// the modification time doubles as the last use for eviction
+	std::error_code error;
+	fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+	stats.hits++;
+	return true;
+}
+
+void DiskCache::store(const std::string& key, const ResultCache::Entry& entry) {
+	std::string content(MAGIC, sizeof(MAGIC));
+	content += (char)entry.success;
+	putString(content, key);
+	putString(content, entry.log);
+	putString(content, entry.dumps);
+
+	// written aside and renamed, so concurrent readers never see half an entry
+	std::string path = entryPath(key);
+	std::string temporary = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+	{
+		std::ofstream file(temporary, std::ios::binary);
+		if(!file.write(content.data(), content.size())) {
+			return;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(temporary, path, error);
+	if(error) {
+		fs::remove(temporary, error);
+		return;
+	}
+
+	stats.stores++;
+}
+
+void DiskCache::evict() {
+	struct File {
+		fs::file_time_type used;
+		uintmax_t size;
+		fs::path path;
+	};
+
+	std::vector<File> files;
+	uintmax_t total = 0;
+	std::error_code error;
+
+	for(const fs::directory_entry& entry : fs::directory_iterator(dir, error)) {
+		if(entry.path().extension() != ".cache") {
+			continue;
+		}
+
+		File file { entry.last_write_time(error), entry.file_size(error), entry.path() };
+		if(!error) {
+			files.push_back(file);
+			total += file.size;
+		}
+	}
+
+	if(total <= maxBytes) {
+		return;
+	}
+
+	std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+		return a.used < b.used;
+	});
+
+	for(const File& file : files) {
+		if(total <= maxBytes) {
+			break;
+		}
+
+		if(fs::remove(file.path, error)) {
+			total -= file.size;
+			stats.evicted++;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include "ResultCache.h"
+
+struct Options;
+
+// Compile results kept on disk between runs. An entry is keyed by the XXH64 of the
+// source text, the build of the compiler, the options that shape the output and the
+// path, which diagnostics name. Touched but unchanged files still hit, renamed ones
+// miss. Every hit refreshes the entry's modification time and evict() removes the
+// least recently used entries first.
+class DiskCache {
+public:
+	struct Stats {
+		std::atomic<size_t> hits { 0 };
+		std::atomic<size_t> misses { 0 };
+		std::atomic<size_t> stores { 0 };
+		std::atomic<size_t> evicted { 0 };
+	};
+
+private:
+	std::string dir;
+	size_t maxBytes;
+	Stats stats;
+
+	std::string entryPath(const std::string& key) const;
+
+public:
+	DiskCache(const std::string& dir, size_t maxBytes) : dir(dir), maxBytes(maxBytes) {}
+
+	bool open();	// creates the directory if needed
+
+	// reads path into source, which is then compiled instead of reading the file again,
+	// so the key always matches what was compiled. False if the file can't be read, it
+	// is then compiled without caching.
+	bool makeKey(const std::string& path, const Options& options, std::string& source, std::string& key) const;
+
+	bool find(const std::string& key, ResultCache::Entry& entry);
+	void store(const std::string& key, const ResultCache::Entry& entry);
+
+	// removes least recently used entries until the cache fits into maxBytes
+	void evict();
+
+	const Stats& getStats() const { return stats; }
+};
@@ -0,0 +1,476 @@
+#include "Driver.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "Lexan.h"
+#include "Synan.h"
+#include "Seman.h"
+#include "IrLowering.h"
+#include "IrVerifier.h"
+#include "IrOptimizer.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include "MemoryStats.h"
+#include "Diagnostics.h"
+#include "Trace.h"
+
+static bool startsWith(const char* arg, const char* prefix) {
+	return strncmp(arg, prefix, strlen(prefix)) == 0;
+}
+
+bool Driver::parseOptions(const std::vector<std::string>& args, Options& options) {
+	std::vector<char*> argv { (char*)"main" };
+	for(const std::string& arg : args) {
+		argv.push_back((char*)arg.c_str());
+	}
+
+	return parseOptions(argv.size(), argv.data(), options);
+}
+
+bool Driver::parseOptions(int argc, char** argv, Options& options) {
+	bool stopGiven = false;
+
+	for(int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+
+		if(strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+			options.help = true;
+		}
+		else if(strcmp(arg, "-o") == 0) {
+			if(i + 1 >= argc) {
+				Logger::getInstance().error("Missing file name after -o");
+				return false;
+			}
+			options.output = argv[++i];
+		}
+		else if(startsWith(arg, "--stop-after=")) {
+			const char* stage = arg + strlen("--stop-after=");
+			stopGiven = true;
+
+			if(strcmp(stage, "lex") == 0) options.stopAfter = Stage::LEX;
+			else if(strcmp(stage, "parse") == 0) options.stopAfter = Stage::PARSE;
+			else if(strcmp(stage, "names") == 0) options.stopAfter = Stage::NAMES;
+			else if(strcmp(stage, "types") == 0) options.stopAfter = Stage::TYPES;
+			else if(strcmp(stage, "ir") == 0) options.stopAfter = Stage::IR;
+			else {
+				Logger::getInstance().error("Unknown stage %s (expected lex, parse, names, types or ir)", stage);
+				return false;
+			}
+		}
+		else if(startsWith(arg, "-j")) {
+			const char* count = arg[2] != '\0' ? arg + 2 : (i + 1 < argc ? argv[++i] : "");
+			char* end;
+			long jobs = strtol(count, &end, 10);
+
+			if(*count == '\0' || *end != '\0' || jobs <= 0) {
+				Logger::getInstance().error("Invalid job count %s", count);
+				return false;
+			}
+			options.jobs = jobs;
+		}
+		else if(strcmp(arg, "--server") == 0) {
+			if(i + 1 >= argc) {
+				Logger::getInstance().error("Missing socket path after --server");
+				return false;
+			}
+			options.server = argv[++i];
+		}
+		else if(strcmp(arg, "--mem-report") == 0) {
+			options.memReport = TimeReport::TEXT;
+		}
+		else if(strcmp(arg, "--mem-report=json") == 0) {
+			options.memReport = TimeReport::JSON;
+		}
+		else if(startsWith(arg, "--cache-dir=")) {
+			options.cacheDir = arg + strlen("--cache-dir=");
+		}
+		else if(startsWith(arg, "--cache-size=")) {
+			const char* size = arg + strlen("--cache-size=");
+			char* end;
+			long megabytes = strtol(size, &end, 10);
+
+			if(*size == '\0' || *end != '\0' || megabytes < 0) {
+				Logger::getInstance().error("Invalid cache size %s", size);
+				return false;
+			}
+			options.cacheSize = (size_t)megabytes << 20;
+		}
+		else if(startsWith(arg, "--trace=")) {
+			options.trace = arg + strlen("--trace=");
+		}
+		else if(strcmp(arg, "--cache-stats") == 0) {
+			options.cacheStats = true;
+		}
+		else if(strcmp(arg, "--dump-tokens") == 0) {
+			options.dumpTokens = true;
+		}
+		else if(strcmp(arg, "--dump-ast") == 0) {
+			options.dumpAst = true;
+		}
+		else if(strcmp(arg, "--dump-ir") == 0) {
+			options.dumpIr = true;
+		}
+		else if(strcmp(arg, "-O0") == 0) {
+			options.optimize = false;
+		}
+		else if(strcmp(arg, "-O1") == 0) {
+			options.optimize = true;
+		}
+		else if(strcmp(arg, "--opt-report") == 0) {
+			options.optReport = true;
+		}
+		else if(startsWith(arg, "--log-file=")) {
+			options.logFile = arg + strlen("--log-file=");
+		}
+		else if(strcmp(arg, "--no-color") == 0) {
+			options.color = false;
+		}
+		else if(strcmp(arg, "--debug") == 0) {
+			options.debug = true;
+		}
+		else if(startsWith(arg, "--max-errors=")) {
+			const char* count = arg + strlen("--max-errors=");
+			char* end;
+			long errors = strtol(count, &end, 10);
+
+			if(*count == '\0' || *end != '\0' || errors < 0) {
+				Logger::getInstance().error("Invalid error limit %s", count);
+				return false;
+			}
+			options.maxErrors = errors;
+		}
+		else if(strcmp(arg, "--check") == 0) {
+			options.check = true;
+		}
+		else if(strcmp(arg, "-ftime-report") == 0) {
+			options.timeReport = TimeReport::TEXT;
+		}
+		else if(strcmp(arg, "-ftime-report=json") == 0) {
+			options.timeReport = TimeReport::JSON;
+		}
+		else if(arg[0] == '-' && arg[1] != '\0') {
+			Logger::getInstance().error("Unknown option %s", arg);
+			return false;
+		}
+		else {
+			options.inputs.push_back(arg);
+		}
+	}
+
+	// lowering and optimization report nothing, check mode only runs them when asked to
+	if(options.check && !stopGiven && !options.dumpIr && !options.optReport) {
+		options.stopAfter = Stage::TYPES;
+	}
+
+	if(options.inputs.empty() && !options.help && options.server.empty()) {
+		Logger::getInstance().error("No input files");
+		return false;
+	}
+
+	return true;
+}
+
+void Driver::printUsage(const char* program) {
+	Logger::getInstance().log("Usage: %s [options] <file>...", program);
+	Logger::getInstance().write(
+		"Options:\n"
+		"  -o <file>             write token, AST and IR dumps to <file>\n"
+		"  -j <count>            compile at most <count> files at once (default: one per core)\n"
+		"  --stop-after=<stage>  stop after lex, parse, names, types or ir\n"
+		"  --dump-tokens         print the tokens of every input\n"
+		"  --dump-ast            print the AST of every input\n"
+		"  --dump-ir             print the IR of every input\n"
+		"  -O0, -O1              leave the IR as lowered, or optimize it (default)\n"
+		"  --opt-report          print the instruction count before and after every optimization\n"
+		"  --check               print only diagnostics, report success through the exit status,\n"
+		"                        stops after types unless --stop-after or an IR dump asks for more\n"
+		"  --max-errors=<N>      show at most N diagnostics per file, 0 for all (default 20)\n"
+		"  -ftime-report[=json]  print per-phase timings\n"
+		"  --mem-report[=json]   print allocations per phase and peak memory\n"
+		"  --trace=<file>        write a Chrome trace (chrome://tracing, Perfetto) of the run\n"
+		"  --cache-dir=<dir>     reuse results of unchanged files from <dir>\n"
+		"  --cache-size=<MB>     evict least recently used entries above this size (default 256)\n"
+		"  --cache-stats         print cache hits, misses and evictions\n"
+		"  --server <socket>     keep running and serve compile requests on a Unix socket\n"
+		"  --log-file=<file>     write all messages to <file> instead of stdout\n"
+		"  --no-color            print without terminal colors and font styles\n"
+		"  --debug               trace the parser and resolvers (debug builds only)\n"
+		"  -h, --help            print this message\n"
+	);
+}
+
+int Driver::run() {
+	Logger::getInstance().setQuiet(options.check);
+	Logger::getInstance().setDebug(options.debug);
+	Font::enabled = options.color;
+
+	if(options.debug && !Logger::DEBUG_LOGS) {
+		Logger::getInstance().error("Debug output is compiled out of release builds, use make debug");
+	}
+	TimeReport::getInstance().reset(options.timeReport);
+
+	if(options.memReport != TimeReport::NONE) {
+		MemoryStats::enable();
+		MemoryStats::reset();
+	}
+
+	if(!options.trace.empty()) {
+		Trace::setThreadName("main");
+		Trace::getInstance().start();
+	}
+
+	// output is written from pool threads, so it has to follow the caller's capture by hand
+	sink = Logger::getInstance().capture(nullptr);
+	Logger::getInstance().capture(sink);
+
+	std::ofstream file;
+	if(!options.output.empty()) {
+		file.open(options.output);
+		if(!file) {
+			Logger::getInstance().error("Cannot open output file %s", options.output.c_str());
+			return -1;
+		}
+	}
+	std::ostream& out = options.output.empty() ? std::cout : file;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::unique_ptr<DiskCache> diskCache;
+	if(!options.cacheDir.empty()) {
+		diskCache.reset(new DiskCache(options.cacheDir, options.cacheSize));
+		if(!diskCache->open()) {
+			Logger::getInstance().error("Cannot create cache directory %s", options.cacheDir.c_str());
+			return -1;
+		}
+		disk = diskCache.get();
+	}
+
+	size_t count = options.inputs.size();
+	size_t lanes = options.jobs ? options.jobs : ThreadPool::getInstance().size();
+	lanes = std::min(lanes, count);
+
+	results.assign(count, Result());
+	emitted = 0;
+	std::atomic<size_t> next { 0 };
+
+	// every lane pulls the next input, so at most `lanes` files are in memory at once
+	ThreadPool::getInstance().parallelFor(lanes, [&](size_t) {
+		for(size_t i = next++; i < count; i = next++) {
+			compileCached(i);
+			emit(i, out);
+		}
+	});
+
+	if(disk) {
+		disk->evict();
+	}
+
+	// compilation output is complete, reports come after it
+	Logger::getInstance().flush();
+
+	bool result = true;
+	for(const Result& file : results) {
+		result = result && file.success;
+	}
+
+	TimeReport::getInstance().setWall(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+	// an explicitly requested report is printed even in check mode
+	Logger::getInstance().setQuiet(false);
+	TimeReport::getInstance().print();
+
+	if(options.memReport != TimeReport::NONE) {
+		MemoryStats::print(options.memReport == TimeReport::JSON);
+	}
+
+	if(!options.trace.empty() && !Trace::getInstance().write(options.trace)) {
+		Logger::getInstance().error("Cannot write trace file %s", options.trace.c_str());
+	}
+
+	if(disk && options.cacheStats) {
+		const DiskCache::Stats& stats = disk->getStats();
+		Logger::getInstance().log("Cache: %zu hits, %zu misses, %zu stored, %zu evicted", stats.hits.load(), stats.misses.load(), stats.stores.load(), stats.evicted.load());
+	}
+
+	disk = nullptr;
+	return result ? 0 : -1;
+}
+
+void Driver::compileCached(size_t index) {
+	const std::string& path = options.inputs[index];
+	Result& result = results[index];
+
+	ResultCache::Entry entry;
+	std::string key, diskKey, source;
+	bool cacheable = cache && ResultCache::makeKey(path, options, key);
+	bool diskCacheable = disk && disk->makeKey(path, options, source, diskKey);
+
+	if(cacheable && cache->find(key, entry)) {
+		result.log = entry.log;
+		result.dumps = entry.dumps;
+		result.success = entry.success;
+		return;
+	}
+
+	if(diskCacheable && disk->find(diskKey, entry)) {
+		result.log = entry.log;
+		result.dumps = entry.dumps;
+		result.success = entry.success;
+	}
+	else {
+		std::string* previous = Logger::getInstance().capture(&result.log);
+		result.success = compile(path, diskCacheable ? &source : nullptr, result.dumps);
+		Logger::getInstance().capture(previous);
+
+		entry = { result.log, result.dumps, result.success };
+		if(diskCacheable) {
+			disk->store(diskKey, entry);
+		}
+	}
+
+	if(cacheable) {
+		cache->store(key, entry);
+	}
+}
+
+void Driver::emit(size_t index, std::ostream& out) {
+	std::lock_guard<std::mutex> guard(emitLock);
+	results[index].done = true;
+
+	// write out every finished input that is next in command line order
+	for(; emitted < results.size() && results[emitted].done; emitted++) {
+		Result& result = results[emitted];
+
+		if(sink) {
+			*sink += result.log;
+		}
+		else {
+			Logger::getInstance().write(result.log);
+		}
+		out << result.dumps;
+
+		// keeps files in command line order even though lanes log from different threads
+		Logger::getInstance().submit();
+
+		std::string().swap(result.log);
+		std::string().swap(result.dumps);
+	}
+}
+
+void Driver::dump(const std::string& text, std::string& dumps) {
+	// stdout dumps are interleaved with the log, -o ones go to their own file
+	if(options.output.empty()) {
+		Logger::getInstance().write(text);
+	}
+	else {
+		dumps += text;
+	}
+}
+
+bool Driver::compile(const std::string& path, const std::string* source, std::string& dumps) {
+	TRACE_SCOPE("compile", path.c_str());
+
+	// collected over every phase and printed once the file is done
+	Diagnostics diagnostics;
+	Diagnostics* previous = Diagnostics::collect(&diagnostics);
+	bool result = runPhases(path, source, dumps);
+	Diagnostics::collect(previous);
+
+	diagnostics.print(path, options.maxErrors, source);
+	return result;
+}
+
+bool Driver::runPhases(const std::string& path, const std::string* source, std::string& dumps) {
+	Lexan lexan;
+	{
+		ScopedTimer timer("lexical analysis");
+		MemoryScope memory(MemoryStats::LEX);
+		std::istringstream text;
+		if(source) {
+			text.str(*source);
+		}
+		if(!(source ? lexan.parse(text) : lexan.parse(path)))
+			return false;
+		timer.count(lexan.getTokens().size(), "tokens");
+	}
+
+	if(options.dumpTokens) {
+		std::ostringstream stream;
+		lexan.printTokens(stream);
+		dump(stream.str(), dumps);
+	}
+
+	if(options.stopAfter == Stage::LEX)
+		return true;
+
+	Synan synan(lexan);
+	{
+		ScopedTimer timer("syntax analysis");
+		MemoryScope memory(MemoryStats::PARSE);
+		if(!synan.parse())
+			return false;
+		timer.count(synan.getNodeCount(), "nodes");
+	}
+
+	if(options.dumpAst) {
+		std::ostringstream stream;
+		synan.printDecls(stream);
+		dump(stream.str(), dumps);
+	}
+
+	if(options.stopAfter == Stage::PARSE)
+		return true;
+
+	Seman seman(synan);
+	{
+		ScopedTimer timer("name resolution");
+		MemoryScope memory(MemoryStats::NAMES);
+		if(!seman.resolveNames())
+			return false;
+		timer.count(synan.getNodeCount(), "nodes");
+		timer.symbols(seman.getSymbolCount());
+	}
+
+	if(options.stopAfter == Stage::NAMES)
+		return true;
+
+	{
+		ScopedTimer timer("type resolution");
+		MemoryScope memory(MemoryStats::TYPES);
+		if(!seman.resolveTypes())
+			return false;
+		timer.count(synan.getNodeCount(), "nodes");
+	}
+
+	if(options.stopAfter == Stage::TYPES)
+		return true;
+
+	IrModule module;
+	{
+		ScopedTimer timer("ir lowering");
+		MemoryScope memory(MemoryStats::IR);
+		IrLowering lowering(module);
+		if(!lowering.lower(synan.getDecls()) || !IrVerifier::verify(module))
+			return false;
+		timer.count(module.getInstrCount(), "instructions");
+	}
+
+	if(options.optimize) {
+		MemoryScope memory(MemoryStats::OPT);
+		IrOptimizer(module, options.optReport).optimize();
+		if(!IrVerifier::verify(module))
+			return false;
+	}
+
+	if(options.dumpIr) {
+		std::ostringstream stream;
+		module.print(stream);
+		dump(stream.str(), dumps);
+	}
+
+	return true;
+}
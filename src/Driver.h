@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <mutex>
+#include "Timer.h"
+#include "ResultCache.h"
+#include "DiskCache.h"
+
+// Last phase run by the driver
+enum class Stage {
+	LEX,
+	PARSE,
+	NAMES,
+	TYPES,
+	IR
+};
+
+struct Options {
+	std::vector<std::string> inputs;
+	std::string output;				// token, AST and IR dumps, stdout if empty
+	Stage stopAfter = Stage::IR;	// TYPES in check mode, unless given or IR is dumped
+	bool dumpTokens = false;
+	bool dumpAst = false;
+	bool dumpIr = false;
+	bool optimize = true;			// -O1, off with -O0
+	bool optReport = false;			// instructions before and after every pass
+	bool check = false;				// only report diagnostics and the exit status
+	size_t maxErrors = 20;			// diagnostics shown per file, 0: all
+	bool help = false;
+	bool debug = false;				// parser and resolver traces, debug builds only
+	bool color = true;
+	std::string logFile;			// messages go here instead of stdout
+	size_t jobs = 0;				// files compiled at once, 0: one per pool thread
+	std::string server;				// run as a compile server on this socket
+	std::string cacheDir;			// on-disk result cache, off if empty
+	size_t cacheSize = 256 << 20;	// bytes kept in cacheDir
+	bool cacheStats = false;
+	std::string trace;				// Chrome trace of the run, off if empty
+	TimeReport::Format memReport = TimeReport::NONE;
+	TimeReport::Format timeReport = TimeReport::NONE;
+};
+
+class Driver {
+private:
+	const Options& options;
+	ResultCache* cache;
+	DiskCache* disk = nullptr;
+	std::string* sink = nullptr;	// log capture of the calling thread
+
+	// per input, kept until every earlier input has been written out
+	struct Result {
+		std::string log;
+		std::string dumps;		// only used with -o
+		bool success = false;
+		bool done = false;
+	};
+
+	std::vector<Result> results;
+	size_t emitted = 0;			// inputs already written out
+	std::mutex emitLock;
+
+	void compileCached(size_t index);
+	// source: the file's text if it has already been read, nullptr reads path
+	bool compile(const std::string& path, const std::string* source, std::string& dumps);
+	bool runPhases(const std::string& path, const std::string* source, std::string& dumps);
+	void dump(const std::string& text, std::string& dumps);
+	void emit(size_t index, std::ostream& out);
+
+public:
+	Driver(const Options& options, ResultCache* cache = nullptr) : options(options), cache(cache) {}
+
+	// false on invalid usage, the reason has already been reported
+	static bool parseOptions(int argc, char** argv, Options& options);
+	static bool parseOptions(const std::vector<std::string>& args, Options& options);
+	static void printUsage(const char* program);
+
+	// compiles every input, returns the process exit status
+	int run();
+};
@@ -0,0 +1,272 @@
+#include "ExprHasher.h"
+#include "Ast.h"
+#include <functional>
+
+// each node kind gets its own seed so e.g. -x and x++ don't collide
+enum HashSeed {
+	CONST_SEED = 0x9e3779b9,
+	NAMED_SEED = 0x85ebca6b,
+	CALL_SEED = 0xc2b2ae35,
+	CAST_SEED = 0x27d4eb2f,
+	PREFIX_SEED = 0x165667b1,
+	POSTFIX_SEED = 0xd3a2646c,
+	BINARY_SEED = 0xfd7046c5,
+	SIZEOF_SEED = 0x61c88647
+};
+
+static size_t combine(size_t seed, size_t value) {
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+size_t ExprHasher::hashType(AstType* type) {
+	size_t hash = type->type;
+
+	switch(type->type) {
+		case AstType::NAMED: return combine(hash, std::hash<std::string>()(((AstNamedType*)type)->name));
+		case AstType::PTR: return combine(hash, hashType(((AstPtrType*)type)->ptrType));
+		case AstType::ARRAY: return combine(combine(hash, hashType(((AstArrayType*)type)->arrayType)), ((AstArrayType*)type)->expr->hash);
+		default: return hash;
+	}
+}
+
+
+
+bool ExprHasher::visit(AstVarDecl* varDecl, Phase phase) {
+	if(!varDecl->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(varDecl->expr && !varDecl->expr->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstParDecl* parDecl, Phase phase) {
+	for(AstVarDecl& decl : parDecl->params) {
+		if(!decl.accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstFunDecl* funDecl, Phase phase) {
+	if(!funDecl->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(funDecl->params && !funDecl->params->accept(this, phase)) {
+		return false;
+	}
+
+	if(funDecl->body && !funDecl->body->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstTypeDecl* typeDecl, Phase phase) {
+	return typeDecl->type->accept(this, phase);
+}
+
+bool ExprHasher::visit(AstStructDecl* structDecl, Phase phase) {
+	for(AstVarDecl& decl : structDecl->fields) {
+		if(!decl.accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+bool ExprHasher::visit(AstAtomType* atomType, Phase phase) {
+	return true;
+}
+
+bool ExprHasher::visit(AstNamedType* namedType, Phase phase) {
+	return true;
+}
+
+bool ExprHasher::visit(AstPtrType* ptrType, Phase phase) {
+	return ptrType->ptrType->accept(this, phase);
+}
+
+bool ExprHasher::visit(AstArrayType* arrayType, Phase phase) {
+	if(!arrayType->arrayType->accept(this, phase)) {
+		return false;
+	}
+
+	return arrayType->expr->accept(this, phase);
+}
+
+
+
+bool ExprHasher::visit(AstConstExpr* constExpr, Phase phase) {
+	size_t hash = combine(CONST_SEED, constExpr->type);
+
+	switch(constExpr->type) {
+		case Token::NUMBER: hash = combine(hash, std::hash<int>()(constExpr->ivalue)); break;
+		case Token::CHARACTER: hash = combine(hash, std::hash<char>()(constExpr->cvalue)); break;
+		case Token::FNUMBER: hash = combine(hash, std::hash<float>()(constExpr->fvalue)); break;
+		case Token::STRING: hash = combine(hash, std::hash<std::string>()(constExpr->str)); break;
+		default: break;
+	}
+
+	constExpr->hash = hash;
+	return true;
+}
+
+bool ExprHasher::visit(AstNamedExpr* namedExpr, Phase phase) {
+	// the resolved declaration tells shadowed names apart
+	namedExpr->hash = combine(NAMED_SEED, std::hash<AstDecl*>()(namedExpr->declaration));
+	return true;
+}
+
+bool ExprHasher::visit(AstCallExpr* callExpr, Phase phase) {
+	size_t hash = combine(CALL_SEED, std::hash<AstDecl*>()(callExpr->declaration));
+
+	for(AstExpr* expr : callExpr->args) {
+		if(!expr->accept(this, phase)) {
+			return false;
+		}
+		hash = combine(hash, expr->hash);
+	}
+
+	callExpr->hash = hash;
+	return true;
+}
+
+bool ExprHasher::visit(AstCastExpr* castExpr, Phase phase) {
+	if(!castExpr->type->accept(this, phase)) {
+		return false;
+	}
+
+	if(!castExpr->expr->accept(this, phase)) {
+		return false;
+	}
+
+	castExpr->hash = combine(combine(CAST_SEED, hashType(castExpr->type)), castExpr->expr->hash);
+	return true;
+}
+
+bool ExprHasher::visit(AstPrefixExpr* prefixExpr, Phase phase) {
+	if(!prefixExpr->expr->accept(this, phase)) {
+		return false;
+	}
+
+	prefixExpr->hash = combine(combine(PREFIX_SEED, prefixExpr->op), prefixExpr->expr->hash);
+	return true;
+}
+
+bool ExprHasher::visit(AstPostfixExpr* postfixExpr, Phase phase) {
+	if(!postfixExpr->expr->accept(this, phase)) {
+		return false;
+	}
+
+	size_t hash = combine(combine(POSTFIX_SEED, postfixExpr->op), postfixExpr->expr->hash);
+
+	if(postfixExpr->index) {
+		if(!postfixExpr->index->accept(this, phase)) {
+			return false;
+		}
+		hash = combine(hash, postfixExpr->index->hash);
+	}
+	else if(postfixExpr->type == 1) {
+		hash = combine(hash, std::hash<std::string>()(postfixExpr->name));
+	}
+
+	postfixExpr->hash = hash;
+	return true;
+}
+
+bool ExprHasher::visit(AstBinaryExpr* binaryExpr, Phase phase) {
+	if(!binaryExpr->left->accept(this, phase)) {
+		return false;
+	}
+
+	if(!binaryExpr->right->accept(this, phase)) {
+		return false;
+	}
+
+	binaryExpr->hash = combine(combine(combine(BINARY_SEED, binaryExpr->op), binaryExpr->left->hash), binaryExpr->right->hash);
+	return true;
+}
+
+bool ExprHasher::visit(AstSizeofExpr* sizeofExpr, Phase phase) {
+	if(!sizeofExpr->type->accept(this, phase)) {
+		return false;
+	}
+
+	sizeofExpr->hash = combine(SIZEOF_SEED, hashType(sizeofExpr->type));
+	return true;
+}
+
+
+
+bool ExprHasher::visit(AstExprStmt* exprStmt, Phase phase) {
+	return exprStmt->expr->accept(this, phase);
+}
+
+bool ExprHasher::visit(AstAssignStmt* assignStmt, Phase phase) {
+	if(!assignStmt->left->accept(this, phase)) {
+		return false;
+	}
+
+	return assignStmt->right->accept(this, phase);
+}
+
+bool ExprHasher::visit(AstCompStmt* compStmt, Phase phase) {
+	for(AstStmt* stmt : compStmt->stmts) {
+		if(!stmt->accept(this, phase)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstIfStmt* ifStmt, Phase phase) {
+	if(!ifStmt->cond->accept(this, phase)) {
+		return false;
+	}
+
+	if(!ifStmt->stmt->accept(this, phase)) {
+		return false;
+	}
+
+	if(ifStmt->elseStmt && !ifStmt->elseStmt->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstWhileStmt* whileStmt, Phase phase) {
+	if(!whileStmt->cond->accept(this, phase)) {
+		return false;
+	}
+
+	return whileStmt->stmt->accept(this, phase);
+}
+
+bool ExprHasher::visit(AstReturnStmt* returnStmt, Phase phase) {
+	if(returnStmt->expr && !returnStmt->expr->accept(this, phase)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool ExprHasher::visit(AstVarStmt* varStmt, Phase phase) {
+	return varStmt->decl.accept(this, phase);
+}
+
+bool ExprHasher::visit(AstFunStmt* funStmt, Phase phase) {
+	return funStmt->decl->accept(this, phase);
+}
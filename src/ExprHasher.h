@@ -0,0 +1,39 @@
+#pragma once
+#include "Visitor.h"
+
+// Computes AstExpr::hash bottom-up in a single pass over the typed AST.
+// Equal subtrees get equal hashes, use AstExpr::structEquals to confirm a match.
+class ExprHasher : public Visitor {
+private:
+	size_t hashType(AstType* type);
+
+public:
+	bool visit(AstVarDecl* varDecl, Phase phase) override;
+	bool visit(AstParDecl* parDecl, Phase phase) override;
+	bool visit(AstFunDecl* funDecl, Phase phase) override;
+	bool visit(AstTypeDecl* typeDecl, Phase phase) override;
+	bool visit(AstStructDecl* structDecl, Phase phase) override;
+
+	bool visit(AstAtomType* atomType, Phase phase) override;
+	bool visit(AstNamedType* namedType, Phase phase) override;
+	bool visit(AstPtrType* ptrType, Phase phase) override;
+	bool visit(AstArrayType* arrayType, Phase phase) override;
+	
+	bool visit(AstConstExpr* constExpr, Phase phase) override;
+	bool visit(AstNamedExpr* namedExpr, Phase phase) override;
+	bool visit(AstCallExpr* callExpr, Phase phase) override;
+	bool visit(AstCastExpr* castExpr, Phase phase) override;
+	bool visit(AstPrefixExpr* prefixExpr, Phase phase) override;
+	bool visit(AstPostfixExpr* postfixExpr, Phase phase) override;
+	bool visit(AstBinaryExpr* binaryExpr, Phase phase) override;
+	bool visit(AstSizeofExpr* sizeofExpr, Phase phase) override;
+
+	bool visit(AstExprStmt* exprStmt, Phase phase) override;
+	bool visit(AstAssignStmt* assignStmt, Phase phase) override;
+	bool visit(AstCompStmt* compStmt, Phase phase) override;
+	bool visit(AstIfStmt* ifStmt, Phase phase) override;
+	bool visit(AstWhileStmt* whileStmt, Phase phase) override;
+	bool visit(AstReturnStmt* returnStmt, Phase phase) override;
+	bool visit(AstVarStmt* varStmt, Phase phase) override;
+	bool visit(AstFunStmt* funStmt, Phase phase) override;
+};
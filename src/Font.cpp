@@ -1,6 +1,8 @@
 #include "Font.h"
 #include <sstream>
 
+bool Font::enabled = true;
+
 const std::string Font::reset = "\x1B[0m";
 const std::string Font::bold = "\x1B[1m";
 const std::string Font::faint = "\x1B[2m";
@@ -6,6 +6,7 @@ public:
     static const std::string reset, bold, faint, italic, underline, inverse, striked;
     static const std::string fblack, fred, fgreen, fyellow, fblue, fmagenta, fcyan, fwhite;
     static const std::string bblack, bred, bgreen, byellow, bblue, bmagenta, bcyan, bwhite;
+    static bool enabled;    // false: callers leave out font codes (--no-color)
 public:
     static std::string byColorCode(int r, int g, int b, bool fg = true);
 };
@@ -0,0 +1,90 @@
+#include "Hash.h"
+#include <cstring>
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t rotl(uint64_t value, int bits) {
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// unaligned little-endian reads, the hash is only used on x86 and arm hosts
+static uint64_t read64(const unsigned char* data) {
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint32_t read32(const unsigned char* data) {
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint64_t mixRound(uint64_t acc, uint64_t input) {
+	acc += input * PRIME2;
+	acc = rotl(acc, 31);
+	return acc * PRIME1;
+}
+
+static uint64_t mergeRound(uint64_t acc, uint64_t value) {
+	acc ^= mixRound(0, value);
+	return acc * PRIME1 + PRIME4;
+}
+
+uint64_t xxhash64(const void* input, size_t size, uint64_t seed) {
+	const unsigned char* data = (const unsigned char*)input;
+	const unsigned char* end = data + size;
+	uint64_t hash;
+
+	if(size >= 32) {
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+
+		for(; data + 32 <= end; data += 32) {
+			v1 = mixRound(v1, read64(data));
+			v2 = mixRound(v2, read64(data + 8));
+			v3 = mixRound(v3, read64(data + 16));
+			v4 = mixRound(v4, read64(data + 24));
+		}
+
+		hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		hash = mergeRound(hash, v1);
+		hash = mergeRound(hash, v2);
+		hash = mergeRound(hash, v3);
+		hash = mergeRound(hash, v4);
+	}
+	else {
+		hash = seed + PRIME5;
+	}
+
+	hash += size;
+
+	for(; data + 8 <= end; data += 8) {
+		hash ^= mixRound(0, read64(data));
+		hash = rotl(hash, 27) * PRIME1 + PRIME4;
+	}
+
+	if(data + 4 <= end) {
+		hash ^= read32(data) * PRIME1;
+		hash = rotl(hash, 23) * PRIME2 + PRIME3;
+		data += 4;
+	}
+
+	for(; data < end; data++) {
+		hash ^= *data * PRIME5;
+		hash = rotl(hash, 11) * PRIME1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
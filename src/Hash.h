@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 64-bit XXH64 hash, fast enough to fingerprint whole source files
+uint64_t xxhash64(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t xxhash64(const std::string& data, uint64_t seed = 0) {
+	return xxhash64(data.data(), data.size(), seed);
+}
@@ -0,0 +1,419 @@
+#include "Ir.h"
+#include "IrCfg.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+void* IrArena::allocate(size_t size, size_t align) {
+	size_t padding = (align - (size_t)next % align) % align;
+
+	if(size + padding > left) {
+		size_t chunk = std::max(CHUNK_SIZE, size + align);
+		chunks.emplace_back(new char[chunk]);
+		next = chunks.back().get();
+		left = chunk;
+		padding = (align - (size_t)next % align) % align;
+	}
+
+	void* memory = next + padding;
+	next += padding + size;
+	left -= padding + size;
+	return memory;
+}
+
+
+IrInstr* IrBlock::append(IrInstr* instr) {
+	instr->block = this;
+	instrs.push_back(instr);
+	return instr;
+}
+
+std::vector<IrBlock*> IrBlock::successors() const {
+	IrInstr* last = terminator();
+
+	if(last == nullptr || last->op == IrOp::RET) {
+		return {};
+	}
+	if(last->op == IrOp::BR) {
+		return { last->targets[0] };
+	}
+	return { last->targets[0], last->targets[1] };
+}
+
+
+IrFunction::IrFunction(const std::string& name, IrType returnType) : name(name), returnType(returnType) {}
+
+IrFunction::~IrFunction() {}
+
+IrBlock* IrFunction::addBlock() {
+	blocks.emplace_back(new IrBlock(blocks.size(), this));
+	changedCfg();
+	return blocks.back().get();
+}
+
+const IrCfg& IrFunction::cfg() const {
+	if(!analysis) {
+		analysis.reset(new IrCfg());
+	}
+
+	if(analysisVersion != cfgVersion) {
+		analysis->compute(*this);
+		analysisVersion = cfgVersion;
+	}
+	return *analysis;
+}
+
+void IrFunction::orderBlocks() {
+	if(blocks.empty()) {
+		return;
+	}
+
+	// iterative depth first search, a block is finished once all its successors are
+	std::vector<IrBlock*> postorder;
+	std::unordered_set<IrBlock*> visited { entry() };
+	std::vector<std::pair<IrBlock*, size_t>> stack { { entry(), 0 } };
+
+	while(!stack.empty()) {
+		IrBlock* block = stack.back().first;
+		std::vector<IrBlock*> successors = block->successors();
+
+		if(stack.back().second < successors.size()) {
+			IrBlock* next = successors[stack.back().second++];
+			if(visited.insert(next).second) {
+				stack.push_back({ next, 0 });
+			}
+		}
+		else {
+			postorder.push_back(block);
+			stack.pop_back();
+		}
+	}
+
+	std::unordered_map<IrBlock*, std::unique_ptr<IrBlock>> owned;
+	for(auto& block : blocks) {
+		owned[block.get()] = std::move(block);
+	}
+
+	blocks.clear();
+	for(auto it = postorder.rbegin(); it != postorder.rend(); it++) {
+		blocks.push_back(std::move(owned[*it]));
+		blocks.back()->id = blocks.size() - 1;
+	}
+
+	// phis drop what came from blocks that are gone
+	for(auto& block : blocks) {
+		for(IrInstr* instr : block->instrs) {
+			if(instr->op != IrOp::PHI) {
+				break;
+			}
+
+			unsigned kept = 0;
+			for(unsigned i = 0; i < instr->count; i++) {
+				if(visited.count(instr->targets[i])) {
+					instr->operands[kept] = instr->operands[i];
+					instr->targets[kept] = instr->targets[i];
+					kept++;
+				}
+			}
+			instr->count = kept;
+		}
+	}
+
+	changedCfg();
+}
+
+size_t IrFunction::getInstrCount() const {
+	size_t count = 0;
+	for(auto& block : blocks) {
+		count += block->instrs.size();
+	}
+	return count;
+}
+
+void IrFunction::replaceUses(const std::unordered_map<IrInstr*, IrInstr*>& replacements) {
+	if(replacements.empty()) {
+		return;
+	}
+
+	for(auto& block : blocks) {
+		for(IrInstr* instr : block->instrs) {
+			for(unsigned i = 0; i < instr->count; i++) {
+				for(auto it = replacements.find(instr->operands[i]); it != replacements.end(); it = replacements.find(it->second)) {
+					instr->operands[i] = it->second;
+				}
+			}
+		}
+	}
+}
+
+
+IrGlobal* IrModule::addGlobal(const std::string& name, int size, int align) {
+	globals.emplace_back(new IrGlobal { name, size, align, nullptr, "" });
+	return globals.back().get();
+}
+
+IrFunction* IrModule::addFunction(const std::string& name, IrType returnType) {
+	functions.emplace_back(new IrFunction(name, returnType));
+	return functions.back().get();
+}
+
+IrInstr* IrModule::addParam(IrFunction* function, IrType type) {
+	IrInstr* param = create(IrOp::PARAM, type, 0);
+	param->ivalue = function->params.size();
+	function->params.push_back(param);
+	return param;
+}
+
+IrInstr* IrModule::create(IrOp op, IrType type, unsigned count) {
+	IrInstr* instr = arena.allocateArray<IrInstr>(1);
+	instr->op = op;
+	instr->type = type;
+	instr->count = count;
+
+	if(count > 0) {
+		instr->operands = arena.allocateArray<IrInstr*>(count);
+	}
+	return instr;
+}
+
+IrBlock** IrModule::createTargets(unsigned count) {
+	return arena.allocateArray<IrBlock*>(count);
+}
+
+IrInstr* IrModule::constant(IrType type, int value) {
+	IrInstr* instr = create(IrOp::CONST, type, 0);
+	instr->ivalue = value;
+	return instr;
+}
+
+IrInstr* IrModule::constant(float value) {
+	IrInstr* instr = create(IrOp::CONST, IrType::FLOAT, 0);
+	instr->fvalue = value;
+	return instr;
+}
+
+IrInstr* IrModule::address(IrGlobal* global) {
+	IrInstr* instr = create(IrOp::GLOBAL, IrType::PTR, 0);
+	instr->global = global;
+	return instr;
+}
+
+IrInstr* IrModule::undef(IrType type) {
+	return create(IrOp::UNDEF, type, 0);
+}
+
+size_t IrModule::getInstrCount() const {
+	size_t count = 0;
+	for(auto& function : functions) {
+		count += function->getInstrCount();
+	}
+	return count;
+}
+
+
+const char* IrModule::typeName(IrType type) {
+	static const char* names[] = { "void", "bool", "char", "int", "float", "ptr" };
+	return names[(int)type];
+}
+
+int IrModule::typeSize(IrType type) {
+	static const int sizes[] = { 0, 1, 1, 4, 4, 8 };
+	return sizes[(int)type];
+}
+
+const char* IrModule::opName(IrOp op) {
+	static const char* names[] = {
+		"const", "param", "global", "undef",
+		"alloca", "load", "store", "copy", "addptr",
+		"add", "sub", "mul", "div", "mod", "and", "or", "xor", "neg", "bnot", "not",
+		"eq", "ne", "lt", "le", "gt", "ge",
+		"cast", "call", "phi",
+		"br", "condbr", "ret"
+	};
+	return names[(int)op];
+}
+
+static std::string constantString(const IrInstr* instr) {
+	switch(instr->type) {
+		case IrType::BOOL: return instr->ivalue ? "true" : "false";
+		case IrType::FLOAT: return std::to_string(instr->fvalue);
+		default: return std::to_string(instr->ivalue);
+	}
+}
+
+static std::string escapeData(const std::string& data) {
+	std::string text;
+	for(unsigned char c : data) {
+		if(c < 0x20 || c >= 0x7f || c == '"' || c == '\\') {
+			const char* hex = "0123456789abcdef";
+			text += '\\';
+			text += hex[c >> 4];
+			text += hex[c & 15];
+		}
+		else {
+			text += c;
+		}
+	}
+	return text;
+}
+
+// prints one function, values are numbered in order of appearance
+class IrPrinter {
+private:
+	std::ostream& out;
+	std::unordered_map<const IrInstr*, unsigned> numbers;
+
+	std::string value(const IrInstr* instr) {
+		switch(instr->op) {
+			case IrOp::CONST: return constantString(instr);
+			case IrOp::GLOBAL: return "@" + instr->global->name;
+			case IrOp::UNDEF: return "undef";
+			default: break;
+		}
+
+		auto it = numbers.find(instr);
+		return it == numbers.end() ? "%?" : "%" + std::to_string(it->second);
+	}
+
+	std::string block(const IrBlock* block) {
+		return "b" + std::to_string(block->id);
+	}
+
+	std::string operands(const IrInstr* instr, unsigned from = 0) {
+		std::string text;
+		for(unsigned i = from; i < instr->count; i++) {
+			text += (i == from ? "" : ", ") + value(instr->operands[i]);
+		}
+		return text;
+	}
+
+	void print(const IrInstr* instr) {
+		std::string type = IrModule::typeName(instr->type);
+		std::string name = IrModule::opName(instr->op);
+		out << "\t";
+
+		if(instr->type != IrType::VOID) {
+			out << value(instr) << " = ";
+		}
+
+		switch(instr->op) {
+			case IrOp::ALLOCA:
+				out << name << " " << instr->ivalue << ", align " << instr->align;
+				break;
+			case IrOp::STORE:
+				out << name << " " << IrModule::typeName(instr->operands[1]->type) << " " << operands(instr);
+				break;
+			case IrOp::COPY:
+				out << name << " " << operands(instr) << ", " << instr->ivalue;
+				break;
+			case IrOp::CALL:
+				out << name << " " << type << " @" << instr->callee->name << "(" << operands(instr) << ")";
+				break;
+			case IrOp::CAST:
+				out << name << " " << IrModule::typeName(instr->operands[0]->type) << " " << value(instr->operands[0]) << " to " << type;
+				break;
+			case IrOp::PHI:
+				out << name << " " << type;
+				for(unsigned i = 0; i < instr->count; i++) {
+					out << (i == 0 ? " " : ", ") << "[" << value(instr->operands[i]) << ", " << block(instr->targets[i]) << "]";
+				}
+				break;
+			case IrOp::BR:
+				out << name << " " << block(instr->targets[0]);
+				break;
+			case IrOp::CONDBR:
+				out << name << " " << value(instr->operands[0]) << ", " << block(instr->targets[0]) << ", " << block(instr->targets[1]);
+				break;
+			case IrOp::RET:
+				out << name;
+				if(instr->count > 0) {
+					out << " " << IrModule::typeName(instr->operands[0]->type) << " " << value(instr->operands[0]);
+				}
+				break;
+			default:
+				// comparisons show the type they compare
+				out << name << " " << (instr->isComparison() ? IrModule::typeName(instr->operands[0]->type) : type.c_str()) << " " << operands(instr);
+				break;
+		}
+
+		out << "\n";
+	}
+
+public:
+	IrPrinter(std::ostream& out) : out(out) {}
+
+	void print(const IrFunction* function) {
+		for(const IrInstr* param : function->params) {
+			numbers[param] = numbers.size();
+		}
+		for(auto& block : function->blocks) {
+			for(const IrInstr* instr : block->instrs) {
+				if(instr->type != IrType::VOID) {
+					numbers[instr] = numbers.size();
+				}
+			}
+		}
+
+		out << (function->isDeclaration() ? "declare " : "function ") << IrModule::typeName(function->returnType) << " @" << function->name << "(";
+		for(size_t i = 0; i < function->params.size(); i++) {
+			out << (i == 0 ? "" : ", ") << IrModule::typeName(function->params[i]->type) << " " << value(function->params[i]);
+		}
+		out << ")";
+
+		if(function->isDeclaration()) {
+			out << "\n\n";
+			return;
+		}
+
+		out << " {\n";
+		const IrCfg& cfg = function->cfg();
+
+		for(auto& block : function->blocks) {
+			out << this->block(block.get()) << ":";
+
+			// the entry has neither predecessors nor an idom
+			if(block->id != 0) {
+				out << "\t\t\t; preds:";
+				for(unsigned pred : cfg.predecessors(block->id)) {
+					out << " b" << pred;
+				}
+				if(cfg.getIdom(block->id) != IrCfg::NONE) {
+					out << "; idom: b" << cfg.getIdom(block->id);
+				}
+				if(cfg.getLoopDepth(block->id) > 0) {
+					out << "; loop depth: " << cfg.getLoopDepth(block->id);
+				}
+			}
+			out << "\n";
+			for(const IrInstr* instr : block->instrs) {
+				print(instr);
+			}
+		}
+		out << "}\n\n";
+	}
+};
+
+void IrModule::print(std::ostream& out) const {
+	for(auto& global : globals) {
+		out << "global @" << global->name << " " << global->size << ", align " << global->align;
+
+		if(!global->data.empty()) {
+			out << " = \"" << escapeData(global->data) << "\"";
+		}
+		else if(global->init && global->init->op == IrOp::GLOBAL) {
+			out << " = @" << global->init->global->name;
+		}
+		else if(global->init) {
+			out << " = " << typeName(global->init->type) << " " << constantString(global->init);
+		}
+		out << "\n";
+	}
+
+	if(!globals.empty()) {
+		out << "\n";
+	}
+
+	for(auto& function : functions) {
+		IrPrinter(out).print(function.get());
+	}
+}
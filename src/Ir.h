@@ -0,0 +1,221 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <ostream>
+#include <type_traits>
+#include <new>
+
+// Three-address intermediate representation. A module holds globals and functions, a
+// function a list of basic blocks, and a block a list of instructions that each compute
+// at most one value and end with exactly one terminator (BR, CONDBR or RET).
+//
+// Instructions are values themselves and refer to their operands directly. Constants,
+// parameters, global addresses and undef are values too, but live outside of blocks.
+// Locals are ALLOCA'd memory at first; the optimizer promotes them to registers.
+// Structs and arrays never are values, they are handled through their address.
+
+enum class IrType : unsigned char {
+	VOID,
+	BOOL,
+	CHAR,
+	INT,
+	FLOAT,
+	PTR
+};
+
+enum class IrOp : unsigned char {
+	// outside of blocks
+	CONST,		// ivalue or fvalue
+	PARAM,		// ivalue is the index
+	GLOBAL,		// address of global
+	UNDEF,
+
+	// memory
+	ALLOCA,		// ivalue bytes aligned to align, always in the entry block
+	LOAD,		// ptr
+	STORE,		// ptr, value
+	COPY,		// destination, source, copies ivalue bytes
+	ADDPTR,		// ptr, int offset in bytes
+
+	// operands have the type of the result
+	ADD,
+	SUB,
+	MUL,
+	DIV,
+	MOD,
+	AND,
+	OR,
+	XOR,
+	NEG,
+	BNOT,		// ~
+	NOT,		// !
+
+	// operands of one type, the result is bool
+	EQ,
+	NE,
+	LT,
+	LE,
+	GT,
+	GE,
+
+	CAST,		// converts its operand to the result type
+	CALL,		// arguments, calls callee
+	PHI,		// one operand per predecessor, from targets[i]
+
+	// terminators
+	BR,			// targets[0]
+	CONDBR,		// bool, targets[0] if true, else targets[1]
+	RET			// value unless the function returns void
+};
+
+class IrBlock;
+class IrFunction;
+class IrCfg;
+struct IrGlobal;
+
+struct IrInstr {
+	IrOp op;
+	IrType type;
+	unsigned count = 0;				// operands
+	IrInstr** operands = nullptr;
+	IrBlock** targets = nullptr;	// successors of BR and CONDBR, incoming blocks of PHI
+	IrBlock* block = nullptr;		// nullptr outside of blocks
+	union {
+		int ivalue = 0;
+		float fvalue;
+	};
+	int align = 0;
+	union {
+		IrGlobal* global = nullptr;
+		IrFunction* callee;
+	};
+
+	bool isTerminator() const { return op == IrOp::BR || op == IrOp::CONDBR || op == IrOp::RET; }
+	bool isComparison() const { return op >= IrOp::EQ && op <= IrOp::GE; }
+	bool hasSideEffects() const { return op == IrOp::STORE || op == IrOp::COPY || op == IrOp::CALL || isTerminator(); }
+};
+
+// Bump allocator for instructions and their operand lists, freed all at once with its module
+class IrArena {
+private:
+	static constexpr size_t CHUNK_SIZE = 64 << 10;
+
+	std::vector<std::unique_ptr<char[]>> chunks;
+	char* next = nullptr;
+	size_t left = 0;
+
+public:
+	void* allocate(size_t size, size_t align);
+
+	template<typename T>
+	T* allocateArray(size_t count) {
+		static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+		T* array = (T*)allocate(count * sizeof(T), alignof(T));
+		for(size_t i = 0; i < count; i++) {
+			new(&array[i]) T();
+		}
+		return array;
+	}
+};
+
+class IrBlock {
+public:
+	unsigned id;
+	IrFunction* function;
+	std::vector<IrInstr*> instrs;
+
+	IrBlock(unsigned id, IrFunction* function) : id(id), function(function) {}
+
+	IrInstr* append(IrInstr* instr);
+	IrInstr* terminator() const { return (!instrs.empty() && instrs.back()->isTerminator()) ? instrs.back() : nullptr; }
+	std::vector<IrBlock*> successors() const;
+};
+
+class IrFunction {
+private:
+	unsigned cfgVersion = 0;
+	mutable unsigned analysisVersion = ~0u;
+	mutable std::unique_ptr<IrCfg> analysis;
+
+public:
+	std::string name;
+	IrType returnType;
+	std::vector<IrInstr*> params;
+	std::vector<std::unique_ptr<IrBlock>> blocks;	// blocks[i]->id == i, blocks[0] is the entry, empty if only declared
+
+	IrFunction(const std::string& name, IrType returnType);
+	~IrFunction();
+
+	IrBlock* addBlock();
+	IrBlock* entry() const { return blocks.front().get(); }
+	bool isDeclaration() const { return blocks.empty(); }
+
+	// keeps the blocks reachable from the entry in reverse postorder and numbers them in that order
+	void orderBlocks();
+	size_t getInstrCount() const;
+
+	// points every operand at its replacement, following chains of replacements
+	void replaceUses(const std::unordered_map<IrInstr*, IrInstr*>& replacements);
+
+	// takes the instructions dead() is true for out of their blocks
+	template<typename Predicate>
+	void removeInstrs(Predicate dead) {
+		for(auto& block : blocks) {
+			size_t kept = 0;
+			for(IrInstr* instr : block->instrs) {
+				if(dead(instr)) {
+					instr->block = nullptr;
+				}
+				else {
+					block->instrs[kept++] = instr;
+				}
+			}
+			block->instrs.resize(kept);
+		}
+	}
+
+	// analyses of the control flow, computed again only after changedCfg()
+	const IrCfg& cfg() const;
+	// has to be called after changing a terminator, addBlock and orderBlocks do it themselves
+	void changedCfg() { cfgVersion++; }
+};
+
+struct IrGlobal {
+	std::string name;
+	int size;
+	int align;
+	IrInstr* init = nullptr;	// CONST or GLOBAL, zero if nullptr
+	std::string data;			// bytes of a string literal, used instead of init if not empty
+};
+
+class IrModule {
+private:
+	IrArena arena;
+
+public:
+	std::vector<std::unique_ptr<IrGlobal>> globals;
+	std::vector<std::unique_ptr<IrFunction>> functions;
+
+	IrGlobal* addGlobal(const std::string& name, int size, int align);
+	IrFunction* addFunction(const std::string& name, IrType returnType);
+	IrInstr* addParam(IrFunction* function, IrType type);
+
+	// a new instruction with room for count operands, not yet in a block
+	IrInstr* create(IrOp op, IrType type, unsigned count);
+	IrBlock** createTargets(unsigned count);
+
+	IrInstr* constant(IrType type, int value);
+	IrInstr* constant(float value);
+	IrInstr* address(IrGlobal* global);
+	IrInstr* undef(IrType type);
+
+	size_t getInstrCount() const;
+	void print(std::ostream& out) const;
+
+	static const char* typeName(IrType type);
+	static int typeSize(IrType type);
+	static const char* opName(IrOp op);
+};
@@ -0,0 +1,234 @@
+#include "IrCfg.h"
+#include <algorithm>
+#include "Ir.h"
+
+void IrCfg::Edges::build(const std::vector<std::vector<unsigned>>& lists) {
+	start.assign(1, 0);
+	data.clear();
+
+	for(const std::vector<unsigned>& list : lists) {
+		data.insert(data.end(), list.begin(), list.end());
+		start.push_back(data.size());
+	}
+}
+
+void IrCfg::compute(const IrFunction& function) {
+	blockCount = function.blocks.size();
+
+	computeEdges(function);
+	computeOrder();
+	computeDominators();
+	computeFrontiers();
+	computeLoops();
+}
+
+void IrCfg::computeEdges(const IrFunction& function) {
+	std::vector<std::vector<unsigned>> succLists(blockCount);
+	std::vector<std::vector<unsigned>> predLists(blockCount);
+
+	for(auto& block : function.blocks) {
+		for(IrBlock* successor : block->successors()) {
+			succLists[block->id].push_back(successor->id);
+			predLists[successor->id].push_back(block->id);
+		}
+	}
+
+	succs.build(succLists);
+	preds.build(predLists);
+}
+
+void IrCfg::computeOrder() {
+	order.clear();
+	orderIndex.assign(blockCount, NONE);
+
+	if(blockCount == 0) {
+		return;
+	}
+
+	// iterative depth first search, a block is finished once all its successors are
+	std::vector<bool> visited(blockCount, false);
+	std::vector<std::pair<unsigned, unsigned>> stack { { 0, 0 } };
+	visited[0] = true;
+
+	while(!stack.empty()) {
+		unsigned block = stack.back().first;
+		Range next = successors(block);
+
+		if(stack.back().second < next.size()) {
+			unsigned successor = next[stack.back().second++];
+			if(!visited[successor]) {
+				visited[successor] = true;
+				stack.push_back({ successor, 0 });
+			}
+		}
+		else {
+			order.push_back(block);
+			stack.pop_back();
+		}
+	}
+
+	std::reverse(order.begin(), order.end());
+	for(unsigned i = 0; i < order.size(); i++) {
+		orderIndex[order[i]] = i;
+	}
+}
+
+void IrCfg::computeDominators() {
+	idom.assign(blockCount, NONE);
+
+	if(blockCount == 0) {
+		return;
+	}
+
+	// walks both fingers up the tree until they meet, the later one in reverse postorder moves
+	auto intersect = [this](unsigned a, unsigned b) {
+		while(a != b) {
+			while(orderIndex[a] > orderIndex[b]) a = idom[a];
+			while(orderIndex[b] > orderIndex[a]) b = idom[b];
+		}
+		return a;
+	};
+
+	idom[0] = 0;
+	bool changed = true;
+
+	while(changed) {
+		changed = false;
+
+		for(size_t i = 1; i < order.size(); i++) {
+			unsigned block = order[i];
+			unsigned dominator = NONE;
+
+			for(unsigned pred : predecessors(block)) {
+				if(idom[pred] == NONE) {
+					continue;
+				}
+				dominator = dominator == NONE ? pred : intersect(pred, dominator);
+			}
+
+			if(idom[block] != dominator) {
+				idom[block] = dominator;
+				changed = true;
+			}
+		}
+	}
+
+	idom[0] = NONE;
+
+	std::vector<std::vector<unsigned>> childLists(blockCount);
+	for(unsigned block : order) {
+		if(idom[block] != NONE) {
+			childLists[idom[block]].push_back(block);
+		}
+	}
+	children.build(childLists);
+
+	// numbers of a depth first walk make dominance a constant time check
+	enter.assign(blockCount, NONE);
+	leave.assign(blockCount, NONE);
+	unsigned counter = 0;
+	std::vector<std::pair<unsigned, unsigned>> stack { { 0, 0 } };
+	enter[0] = counter++;
+
+	while(!stack.empty()) {
+		unsigned block = stack.back().first;
+		Range next = domChildren(block);
+
+		if(stack.back().second < next.size()) {
+			unsigned child = next[stack.back().second++];
+			enter[child] = counter++;
+			stack.push_back({ child, 0 });
+		}
+		else {
+			leave[block] = counter++;
+			stack.pop_back();
+		}
+	}
+}
+
+bool IrCfg::dominates(unsigned a, unsigned b) const {
+	if(!isReachable(a) || !isReachable(b)) {
+		return false;
+	}
+	return enter[a] <= enter[b] && leave[b] <= leave[a];
+}
+
+void IrCfg::computeFrontiers() {
+	// a join point is in the frontier of everything between its predecessors and its idom
+	std::vector<std::vector<unsigned>> lists(blockCount);
+
+	for(unsigned block : order) {
+		Range incoming = predecessors(block);
+		if(incoming.size() < 2) {
+			continue;
+		}
+
+		for(unsigned pred : incoming) {
+			if(!isReachable(pred)) {
+				continue;
+			}
+
+			for(unsigned runner = pred; runner != idom[block]; runner = idom[runner]) {
+				// the rest of the way up was already walked from another predecessor
+				if(!lists[runner].empty() && lists[runner].back() == block) {
+					break;
+				}
+				lists[runner].push_back(block);
+			}
+		}
+	}
+
+	frontiers.build(lists);
+}
+
+void IrCfg::computeLoops() {
+	loops.clear();
+	loopOf.assign(blockCount, NONE);
+
+	// headers in reverse postorder, so an enclosing loop is found before its nested ones
+	std::vector<unsigned> stack;
+	std::vector<bool> inLoop(blockCount, false);
+
+	for(unsigned header : order) {
+		Loop loop { header, NONE, 1, { header } };
+
+		// blocks that reach a back edge without passing the header
+		for(unsigned pred : predecessors(header)) {
+			if(dominates(header, pred)) {
+				stack.push_back(pred);
+			}
+		}
+
+		if(stack.empty()) {
+			continue;
+		}
+
+		inLoop[header] = true;
+		while(!stack.empty()) {
+			unsigned block = stack.back();
+			stack.pop_back();
+
+			if(inLoop[block] || !isReachable(block)) {
+				continue;
+			}
+			inLoop[block] = true;
+			loop.blocks.push_back(block);
+
+			for(unsigned pred : predecessors(block)) {
+				stack.push_back(pred);
+			}
+		}
+
+		for(unsigned block : loop.blocks) {
+			inLoop[block] = false;
+		}
+
+		loop.parent = loopOf[header];
+		loop.depth = loop.parent == NONE ? 1 : loops[loop.parent].depth + 1;
+
+		for(unsigned block : loop.blocks) {
+			loopOf[block] = loops.size();
+		}
+		loops.push_back(std::move(loop));
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+class IrFunction;
+
+// Control flow analyses of one function: edges, reverse postorder, the dominator tree
+// (Cooper, Harvey and Kennedy), dominance frontiers and natural loops. Everything is
+// kept in flat arrays indexed by block id, which runs from 0 to the number of blocks.
+// Use IrFunction::cfg(), it only recomputes them after the control flow has changed.
+class IrCfg {
+public:
+	static constexpr unsigned NONE = ~0u;
+
+	// the blocks one block is connected to, a slice of a flat array
+	struct Range {
+		const unsigned* first;
+		const unsigned* last;
+
+		const unsigned* begin() const { return first; }
+		const unsigned* end() const { return last; }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+		unsigned operator[](size_t i) const { return first[i]; }
+	};
+
+	struct Loop {
+		unsigned header;
+		unsigned parent;				// enclosing loop or NONE
+		unsigned depth;					// 1 for loops that aren't nested
+		std::vector<unsigned> blocks;	// header first
+	};
+
+private:
+	// edges of block b are data[start[b]] up to data[start[b + 1]]
+	struct Edges {
+		std::vector<unsigned> start;
+		std::vector<unsigned> data;
+
+		Range get(unsigned block) const { return { data.data() + start[block], data.data() + start[block + 1] }; }
+		void build(const std::vector<std::vector<unsigned>>& lists);
+	};
+
+	unsigned blockCount = 0;
+	Edges succs;
+	Edges preds;
+	Edges children;					// dominator tree
+	Edges frontiers;
+	std::vector<unsigned> order;		// reachable blocks in reverse postorder
+	std::vector<unsigned> orderIndex;	// position in order, NONE if unreachable
+	std::vector<unsigned> idom;
+	std::vector<unsigned> enter;		// dominator tree preorder and postorder numbers
+	std::vector<unsigned> leave;
+	std::vector<Loop> loops;
+	std::vector<unsigned> loopOf;		// innermost loop of every block
+
+	void computeEdges(const IrFunction& function);
+	void computeOrder();
+	void computeDominators();
+	void computeFrontiers();
+	void computeLoops();
+
+public:
+	void compute(const IrFunction& function);
+
+	unsigned size() const { return blockCount; }
+	Range successors(unsigned block) const { return succs.get(block); }
+	Range predecessors(unsigned block) const { return preds.get(block); }
+	const std::vector<unsigned>& reversePostorder() const { return order; }
+	bool isReachable(unsigned block) const { return orderIndex[block] != NONE; }
+
+	// NONE for the entry and unreachable blocks
+	unsigned getIdom(unsigned block) const { return idom[block]; }
+	Range domChildren(unsigned block) const { return children.get(block); }
+	bool dominates(unsigned a, unsigned b) const;
+	Range frontier(unsigned block) const { return frontiers.get(block); }
+
+	// enclosing loops come before the loops they contain
+	const std::vector<Loop>& getLoops() const { return loops; }
+	unsigned getLoop(unsigned block) const { return loopOf[block]; }
+	unsigned getLoopDepth(unsigned block) const { return loopOf[block] == NONE ? 0 : loops[loopOf[block]].depth; }
+};
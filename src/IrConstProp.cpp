@@ -0,0 +1,374 @@
+#include "IrConstProp.h"
+#include <climits>
+
+bool IrConstProp::Cell::operator==(const Cell& other) const {
+	// compares the bits, so floats equal to themselves even if they're NaN
+	return state == other.state && (state != CONSTANT || (type == other.type && ivalue == other.ivalue));
+}
+
+std::unordered_set<const IrGlobal*> IrConstProp::findConstantGlobals(const IrModule& module) {
+	std::unordered_set<const IrGlobal*> escaped;
+
+	for(auto& global : module.globals) {
+		if(global->init && global->init->op == IrOp::GLOBAL) {
+			escaped.insert(global->init->global);
+		}
+	}
+
+	// stored to, copied or passed somewhere, maybe through a pointer
+	for(auto& function : module.functions) {
+		for(auto& block : function->blocks) {
+			for(IrInstr* instr : block->instrs) {
+				for(unsigned i = 0; i < instr->count; i++) {
+					if(instr->operands[i]->op == IrOp::GLOBAL && (instr->op != IrOp::LOAD || i != 0)) {
+						escaped.insert(instr->operands[i]->global);
+					}
+				}
+			}
+		}
+	}
+
+	std::unordered_set<const IrGlobal*> constants;
+	for(auto& global : module.globals) {
+		if(!escaped.count(global.get()) && global->data.empty() && (global->init == nullptr || global->init->op == IrOp::CONST)) {
+			constants.insert(global.get());
+		}
+	}
+	return constants;
+}
+
+void IrConstProp::run() {
+	if(function.isDeclaration()) {
+		return;
+	}
+
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			for(unsigned i = 0; i < instr->count; i++) {
+				if(instr->operands[i]->block) {
+					users[instr->operands[i]].push_back(instr);
+				}
+			}
+		}
+	}
+
+	executable.assign(function.blocks.size(), false);
+	edgeWork.push_back({ nullptr, function.entry() });
+
+	while(!edgeWork.empty() || !valueWork.empty()) {
+		while(!edgeWork.empty()) {
+			IrBlock* from = edgeWork.back().first;
+			IrBlock* to = edgeWork.back().second;
+			edgeWork.pop_back();
+
+			if(from && !edges.insert(edgeKey(from, to)).second) {
+				continue;
+			}
+
+			// a block seen before only has its phis to redo for the new edge
+			bool first = !executable[to->id];
+			executable[to->id] = true;
+
+			for(IrInstr* instr : to->instrs) {
+				if(!first && instr->op != IrOp::PHI) {
+					break;
+				}
+				visit(instr);
+			}
+		}
+
+		while(!valueWork.empty()) {
+			IrInstr* instr = valueWork.back();
+			valueWork.pop_back();
+
+			if(executable[instr->block->id]) {
+				visit(instr);
+			}
+		}
+	}
+
+	rewrite();
+}
+
+IrConstProp::Cell IrConstProp::cellOf(IrInstr* value) const {
+	Cell cell;
+
+	if(value->op == IrOp::CONST) {
+		cell.state = Cell::CONSTANT;
+		cell.type = value->type;
+		cell.ivalue = value->ivalue;
+	}
+	else if(value->block) {
+		auto it = cells.find(value);
+		if(it != cells.end()) {
+			cell = it->second;
+		}
+	}
+	else {
+		cell.state = Cell::OVERDEFINED;
+	}
+
+	return cell;
+}
+
+void IrConstProp::update(IrInstr* instr, Cell cell) {
+	Cell& old = cells[instr];
+
+	// values only ever move down, a second different constant is overdefined
+	if(old == cell || old.state == Cell::OVERDEFINED || cell.state < old.state) {
+		return;
+	}
+	if(old.state == Cell::CONSTANT && cell.state == Cell::CONSTANT) {
+		cell.state = Cell::OVERDEFINED;
+	}
+
+	old = cell;
+	auto it = users.find(instr);
+	if(it != users.end()) {
+		valueWork.insert(valueWork.end(), it->second.begin(), it->second.end());
+	}
+}
+
+void IrConstProp::visit(IrInstr* instr) {
+	switch(instr->op) {
+		case IrOp::PHI: {
+			Cell cell;
+			for(unsigned i = 0; i < instr->count; i++) {
+				if(isTaken(instr->targets[i], instr->block)) {
+					cell = meet(cell, cellOf(instr->operands[i]));
+				}
+			}
+			update(instr, cell);
+			break;
+		}
+		case IrOp::BR:
+			edgeWork.push_back({ instr->block, instr->targets[0] });
+			break;
+		case IrOp::CONDBR: {
+			Cell condition = cellOf(instr->operands[0]);
+
+			if(condition.state == Cell::OVERDEFINED || (condition.state == Cell::CONSTANT && condition.ivalue)) {
+				edgeWork.push_back({ instr->block, instr->targets[0] });
+			}
+			if(condition.state == Cell::OVERDEFINED || (condition.state == Cell::CONSTANT && !condition.ivalue)) {
+				edgeWork.push_back({ instr->block, instr->targets[1] });
+			}
+			break;
+		}
+		case IrOp::RET:
+		case IrOp::STORE:
+		case IrOp::COPY:
+			break;
+		default:
+			update(instr, evaluate(instr));
+			break;
+	}
+}
+
+IrConstProp::Cell IrConstProp::evaluate(IrInstr* instr) const {
+	Cell result;
+	result.state = Cell::OVERDEFINED;
+
+	if(instr->op == IrOp::LOAD) {
+		const IrInstr* address = instr->operands[0];
+		if(address->op != IrOp::GLOBAL || !constants.count(address->global) || address->global->size != IrModule::typeSize(instr->type)) {
+			return result;
+		}
+
+		// globals without an initializer are zero
+		const IrInstr* init = address->global->init;
+		if(init == nullptr || init->type == instr->type) {
+			result.state = Cell::CONSTANT;
+			result.type = instr->type;
+			result.ivalue = init ? init->ivalue : 0;
+		}
+		return result;
+	}
+
+	bool pure = (instr->op >= IrOp::ADD && instr->op <= IrOp::GE) || instr->op == IrOp::CAST;
+	if(!pure || instr->count > 2) {
+		return result;
+	}
+
+	Cell operands[2];
+	for(unsigned i = 0; i < instr->count; i++) {
+		operands[i] = cellOf(instr->operands[i]);
+
+		if(operands[i].state == Cell::OVERDEFINED) {
+			return result;
+		}
+		if(operands[i].state == Cell::UNKNOWN) {
+			result.state = Cell::UNKNOWN;
+		}
+	}
+
+	if(result.state == Cell::UNKNOWN) {
+		return result;
+	}
+	if(!fold(instr->op, instr->type, operands, instr->count, result)) {
+		result.state = Cell::OVERDEFINED;
+	}
+	return result;
+}
+
+void IrConstProp::rewrite() {
+	std::unordered_map<IrInstr*, IrInstr*> replacements;
+	bool branches = false;
+
+	for(auto& block : function.blocks) {
+		if(!executable[block->id]) {
+			continue;
+		}
+
+		for(IrInstr* instr : block->instrs) {
+			auto it = cells.find(instr);
+
+			if(it != cells.end() && it->second.state == Cell::CONSTANT && !instr->hasSideEffects()) {
+				const Cell& cell = it->second;
+				replacements[instr] = cell.type == IrType::FLOAT ? module.constant(cell.fvalue) : module.constant(cell.type, cell.ivalue);
+			}
+			else if(instr->op == IrOp::PHI) {
+				// incoming values along edges never taken
+				unsigned kept = 0;
+				for(unsigned i = 0; i < instr->count; i++) {
+					if(isTaken(instr->targets[i], block.get())) {
+						instr->operands[kept] = instr->operands[i];
+						instr->targets[kept] = instr->targets[i];
+						kept++;
+					}
+				}
+				instr->count = kept;
+
+				if(kept == 1) {
+					replacements[instr] = instr->operands[0];
+				}
+			}
+			else if(instr->op == IrOp::CONDBR) {
+				Cell condition = cellOf(instr->operands[0]);
+				if(condition.state == Cell::CONSTANT) {
+					instr->op = IrOp::BR;
+					instr->targets[0] = instr->targets[condition.ivalue ? 0 : 1];
+					instr->count = 0;
+					branches = true;
+				}
+			}
+		}
+	}
+
+	function.removeInstrs([&replacements](IrInstr* instr) { return replacements.count(instr) > 0; });
+	function.replaceUses(replacements);
+
+	// drops the blocks no taken edge leads to
+	if(branches) {
+		function.orderBlocks();
+	}
+}
+
+IrConstProp::Cell IrConstProp::meet(const Cell& a, const Cell& b) {
+	if(a.state == Cell::UNKNOWN) {
+		return b;
+	}
+	if(b.state == Cell::UNKNOWN || a == b) {
+		return a;
+	}
+
+	Cell cell;
+	cell.state = Cell::OVERDEFINED;
+	return cell;
+}
+
+bool IrConstProp::fold(IrOp op, IrType type, const Cell* operands, unsigned count, Cell& result) {
+	const Cell& a = operands[0];
+	const Cell& b = operands[count > 1 ? 1 : 0];
+
+	result.state = Cell::CONSTANT;
+	result.type = type;
+
+	// pointers are only ever known to be null
+	if(a.type == IrType::PTR || type == IrType::PTR) {
+		if(op != IrOp::EQ && op != IrOp::NE) {
+			return false;
+		}
+		result.ivalue = (a.ivalue == b.ivalue) == (op == IrOp::EQ);
+		return true;
+	}
+
+	if(op == IrOp::CAST) {
+		if(a.type == IrType::FLOAT) {
+			if(type == IrType::FLOAT) {
+				result.fvalue = a.fvalue;
+			}
+			else if(type == IrType::BOOL) {
+				result.ivalue = a.fvalue != 0;
+			}
+			else if(a.fvalue > -2147483648.0f && a.fvalue < 2147483648.0f) {
+				result.ivalue = type == IrType::CHAR ? (char)(int)a.fvalue : (int)a.fvalue;
+			}
+			else {
+				return false;
+			}
+		}
+		else if(type == IrType::FLOAT) {
+			result.fvalue = (float)a.ivalue;
+		}
+		else if(type == IrType::BOOL) {
+			result.ivalue = a.ivalue != 0;
+		}
+		else {
+			result.ivalue = type == IrType::CHAR ? (char)a.ivalue : a.ivalue;
+		}
+		return true;
+	}
+
+	if(a.type == IrType::FLOAT) {
+		float x = a.fvalue, y = b.fvalue;
+
+		switch(op) {
+			case IrOp::ADD: result.fvalue = x + y; return true;
+			case IrOp::SUB: result.fvalue = x - y; return true;
+			case IrOp::MUL: result.fvalue = x * y; return true;
+			case IrOp::DIV: result.fvalue = x / y; return y != 0;
+			case IrOp::NEG: result.fvalue = -x; return true;
+			case IrOp::EQ: result.ivalue = x == y; return true;
+			case IrOp::NE: result.ivalue = x != y; return true;
+			case IrOp::LT: result.ivalue = x < y; return true;
+			case IrOp::LE: result.ivalue = x <= y; return true;
+			case IrOp::GT: result.ivalue = x > y; return true;
+			case IrOp::GE: result.ivalue = x >= y; return true;
+			default: return false;
+		}
+	}
+
+	// int and char wrap around, division by zero is left for run time
+	int x = a.ivalue, y = b.ivalue;
+	int value;
+
+	switch(op) {
+		case IrOp::ADD: value = (int)((unsigned)x + (unsigned)y); break;
+		case IrOp::SUB: value = (int)((unsigned)x - (unsigned)y); break;
+		case IrOp::MUL: value = (int)((unsigned)x * (unsigned)y); break;
+		case IrOp::DIV:
+		case IrOp::MOD:
+			if(y == 0 || (x == INT_MIN && y == -1)) {
+				return false;
+			}
+			value = op == IrOp::DIV ? x / y : x % y;
+			break;
+		case IrOp::AND: value = x & y; break;
+		case IrOp::OR: value = x | y; break;
+		case IrOp::XOR: value = x ^ y; break;
+		case IrOp::NEG: value = (int)(0u - (unsigned)x); break;
+		case IrOp::BNOT: value = ~x; break;
+		case IrOp::NOT: value = !x; break;
+		case IrOp::EQ: result.ivalue = x == y; return true;
+		case IrOp::NE: result.ivalue = x != y; return true;
+		case IrOp::LT: result.ivalue = x < y; return true;
+		case IrOp::LE: result.ivalue = x <= y; return true;
+		case IrOp::GT: result.ivalue = x > y; return true;
+		case IrOp::GE: result.ivalue = x >= y; return true;
+		default: return false;
+	}
+
+	result.ivalue = type == IrType::CHAR ? (char)value : value;
+	return true;
+}
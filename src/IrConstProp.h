@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "Ir.h"
+
+// Sparse conditional constant propagation (Wegman and Zadeck) over SSA form. Every
+// value starts out unknown and only moves down to a constant and then to overdefined,
+// while blocks are only looked at once an edge into them is known to be taken. So a
+// branch on a constant keeps the code it skips from spoiling the values after it.
+//
+// Afterwards constant values are replaced by constants, branches on constants become
+// jumps and the blocks nothing jumps to anymore are dropped.
+class IrConstProp {
+private:
+	struct Cell {
+		enum State {
+			UNKNOWN,
+			CONSTANT,
+			OVERDEFINED
+		};
+
+		State state = UNKNOWN;
+		IrType type = IrType::VOID;
+		union {
+			int ivalue = 0;
+			float fvalue;
+		};
+
+		bool operator==(const Cell& other) const;
+	};
+
+	IrModule& module;
+	IrFunction& function;
+	const std::unordered_set<const IrGlobal*>& constants;
+
+	std::unordered_map<IrInstr*, Cell> cells;
+	std::unordered_map<IrInstr*, std::vector<IrInstr*>> users;
+	std::unordered_set<uint64_t> edges;						// taken edges, from << 32 | to
+	std::vector<bool> executable;
+	std::vector<std::pair<IrBlock*, IrBlock*>> edgeWork;	// the entry comes from nullptr
+	std::vector<IrInstr*> valueWork;
+
+	static uint64_t edgeKey(const IrBlock* from, const IrBlock* to) { return (uint64_t)from->id << 32 | to->id; }
+	bool isTaken(const IrBlock* from, const IrBlock* to) const { return edges.count(edgeKey(from, to)) > 0; }
+
+	Cell cellOf(IrInstr* value) const;
+	void update(IrInstr* instr, Cell cell);
+	void visit(IrInstr* instr);
+	Cell evaluate(IrInstr* instr) const;
+	void rewrite();
+
+	static Cell meet(const Cell& a, const Cell& b);
+	static bool fold(IrOp op, IrType type, const Cell* operands, unsigned count, Cell& result);
+
+public:
+	IrConstProp(IrModule& module, IrFunction& function, const std::unordered_set<const IrGlobal*>& constants)
+		: module(module), function(function), constants(constants) {}
+
+	// globals with a scalar initializer whose address is only ever loaded from
+	static std::unordered_set<const IrGlobal*> findConstantGlobals(const IrModule& module);
+
+	void run();
+};
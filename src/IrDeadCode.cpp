@@ -0,0 +1,180 @@
+#include "IrDeadCode.h"
+#include <vector>
+#include <unordered_map>
+#include "IrCfg.h"
+
+size_t IrDeadCode::run() {
+	if(function.isDeclaration()) {
+		return 0;
+	}
+
+	size_t before = function.getInstrCount();
+
+	findWriteOnly();
+	markLive();
+	function.removeInstrs([this](IrInstr* instr) { return live.count(instr) == 0; });
+	mergeBlocks();
+
+	return before - function.getInstrCount();
+}
+
+IrInstr* IrDeadCode::baseOf(IrInstr* address) {
+	while(address->op == IrOp::ADDPTR) {
+		address = address->operands[0];
+	}
+	return address;
+}
+
+void IrDeadCode::findWriteOnly() {
+	std::unordered_set<const IrInstr*> read;
+
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			if(instr->op == IrOp::ALLOCA) {
+				writeOnly.insert(instr);
+			}
+
+			// anything but the destination of a write may read it, or let others do so
+			for(unsigned i = 0; i < instr->count; i++) {
+				bool written = i == 0 && (instr->op == IrOp::STORE || instr->op == IrOp::COPY || instr->op == IrOp::ADDPTR);
+				if(!written) {
+					read.insert(baseOf(instr->operands[i]));
+				}
+			}
+		}
+	}
+
+	for(const IrInstr* alloca : read) {
+		writeOnly.erase(alloca);
+	}
+}
+
+bool IrDeadCode::isRoot(IrInstr* instr) const {
+	if(instr->op == IrOp::STORE || instr->op == IrOp::COPY) {
+		return !writeOnly.count(baseOf(instr->operands[0]));
+	}
+	return instr->hasSideEffects();
+}
+
+void IrDeadCode::markLive() {
+	std::vector<IrInstr*> worklist;
+
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			if(isRoot(instr)) {
+				live.insert(instr);
+				worklist.push_back(instr);
+			}
+		}
+	}
+
+	while(!worklist.empty()) {
+		IrInstr* instr = worklist.back();
+		worklist.pop_back();
+
+		for(unsigned i = 0; i < instr->count; i++) {
+			IrInstr* operand = instr->operands[i];
+			if(operand->block && live.insert(operand).second) {
+				worklist.push_back(operand);
+			}
+		}
+	}
+}
+
+void IrDeadCode::mergeBlocks() {
+	const IrCfg& cfg = function.cfg();
+	std::vector<size_t> predCount(function.blocks.size());
+	for(auto& block : function.blocks) {
+		predCount[block->id] = cfg.predecessors(block->id).size();
+	}
+
+	std::unordered_map<IrInstr*, IrInstr*> replacements;
+	bool merged = false;
+
+	for(auto& block : function.blocks) {
+		// emptied by merging it into its predecessor
+		if(block->terminator() == nullptr) {
+			continue;
+		}
+
+		for(IrInstr* jump = block->terminator(); jump->op == IrOp::BR; jump = block->terminator()) {
+			IrBlock* next = jump->targets[0];
+			if(next == block.get() || next->id == 0 || predCount[next->id] != 1) {
+				break;
+			}
+
+			block->instrs.pop_back();
+			jump->block = nullptr;
+
+			for(IrInstr* instr : next->instrs) {
+				if(instr->op == IrOp::PHI) {
+					replacements[instr] = instr->operands[0];
+					instr->block = nullptr;
+				}
+				else {
+					block->append(instr);
+				}
+			}
+			next->instrs.clear();
+
+			// phis after it now get their values from this block
+			for(IrBlock* successor : block->successors()) {
+				for(IrInstr* instr : successor->instrs) {
+					if(instr->op != IrOp::PHI) {
+						break;
+					}
+					for(unsigned i = 0; i < instr->count; i++) {
+						if(instr->targets[i] == next) {
+							instr->targets[i] = block.get();
+						}
+					}
+				}
+			}
+			merged = true;
+		}
+	}
+
+	if(merged) {
+		function.replaceUses(replacements);
+		function.orderBlocks();
+	}
+}
+
+size_t IrDeadCode::removeDeadFunctions(IrModule& module) {
+	bool hasMain = false;
+	for(auto& function : module.functions) {
+		hasMain = hasMain || (function->name == "main" && !function->isDeclaration());
+	}
+
+	// nested functions are named outer.inner, only their outer function can call them
+	std::unordered_set<IrFunction*> reachable;
+	std::vector<IrFunction*> worklist;
+
+	for(auto& function : module.functions) {
+		bool entry = hasMain ? function->name == "main" : (!function->isDeclaration() && function->name.find('.') == std::string::npos);
+		if(entry || function->name == ".init") {
+			reachable.insert(function.get());
+			worklist.push_back(function.get());
+		}
+	}
+
+	while(!worklist.empty()) {
+		IrFunction* function = worklist.back();
+		worklist.pop_back();
+
+		for(auto& block : function->blocks) {
+			for(IrInstr* instr : block->instrs) {
+				if(instr->op == IrOp::CALL && reachable.insert(instr->callee).second) {
+					worklist.push_back(instr->callee);
+				}
+			}
+		}
+	}
+
+	size_t before = module.functions.size();
+	module.functions.erase(std::remove_if(module.functions.begin(), module.functions.end(), [&reachable](const std::unique_ptr<IrFunction>& function) {
+		return reachable.count(function.get()) == 0;
+	}), module.functions.end());
+
+	return before - module.functions.size();
+}
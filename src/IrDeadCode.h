@@ -0,0 +1,32 @@
+#pragma once
+#include <unordered_set>
+#include "Ir.h"
+
+// Dead code elimination. Everything starts out dead except instructions with side
+// effects, and whatever a live instruction uses becomes live too. Stores and copies
+// into allocas nothing ever reads from don't count, so locals that are only written
+// disappear along with their stores. Jumps to a block with no other predecessor are
+// then merged into one block.
+class IrDeadCode {
+private:
+	IrFunction& function;
+	std::unordered_set<const IrInstr*> writeOnly;	// allocas
+	std::unordered_set<IrInstr*> live;
+
+	static IrInstr* baseOf(IrInstr* address);
+	void findWriteOnly();
+	bool isRoot(IrInstr* instr) const;
+	void markLive();
+	void mergeBlocks();
+
+public:
+	IrDeadCode(IrFunction& function) : function(function) {}
+
+	// returns the number of removed instructions
+	size_t run();
+
+	// Removes the functions no call reaches from main and .init. Without a main every
+	// top level function is kept, so only unused nested functions and declarations go.
+	// Returns the number of removed functions.
+	static size_t removeDeadFunctions(IrModule& module);
+};
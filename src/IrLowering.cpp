@@ -0,0 +1,876 @@
+#include "IrLowering.h"
+#include <unordered_set>
+#include <algorithm>
+#include "Layout.h"
+#include "ConstFolder.h"
+
+IrType IrLowering::irType(AstType* type) {
+	switch(Layout::resolve(type)->type) {
+		case AstType::INT: return IrType::INT;
+		case AstType::CHAR: return IrType::CHAR;
+		case AstType::BOOL: return IrType::BOOL;
+		case AstType::FLOAT: return IrType::FLOAT;
+		case AstType::VOID: return IrType::VOID;
+		default: return IrType::PTR;	// pointers, and structs and arrays through their address
+	}
+}
+
+bool IrLowering::isAggregate(AstType* type) {
+	type = Layout::resolve(type);
+	return type->type == AstType::ARRAY || type->type == AstType::NAMED;
+}
+
+bool IrLowering::lower(std::vector<AstDecl*>& decls) {
+	for(AstDecl* decl : decls) {
+		valid = decl->accept(this, Phase::HEAD) && valid;
+	}
+
+	resolveCaptures();
+	declareFunctions();
+
+	for(AstDecl* decl : decls) {
+		valid = decl->accept(this, Phase::BODY) && valid;
+	}
+
+	// running .init before main is left to whoever executes the module
+	if(!initializers.empty()) {
+		beginFunction(module.addFunction(".init", IrType::VOID));
+		for(AstVarDecl* varDecl : initializers) {
+			lowerStore(module.address(globals[varDecl]), varDecl->type, varDecl->expr);
+		}
+		endFunction();
+	}
+
+	return valid;
+}
+
+void IrLowering::resolveCaptures() {
+	// a function also needs whatever its callees capture, unless it owns the variable
+	bool changed = true;
+
+	while(changed) {
+		changed = false;
+
+		for(AstFunDecl* decl : order) {
+			FunctionInfo& info = functions[decl];
+
+			for(AstFunDecl* callee : info.callees) {
+				std::vector<AstVarDecl*> captures = functions[callee].captures;
+
+				for(AstVarDecl* capture : captures) {
+					if(owners[capture] != decl && std::find(info.captures.begin(), info.captures.end(), capture) == info.captures.end()) {
+						info.captures.push_back(capture);
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+}
+
+void IrLowering::declareFunctions() {
+	std::unordered_set<std::string> names;
+
+	for(AstFunDecl* decl : order) {
+		FunctionInfo& info = functions[decl];
+
+		// nested functions of the same name in different blocks get a number
+		std::string base = info.parent ? functions[info.parent].function->name + "." + decl->name : decl->name;
+		std::string name = base;
+		for(int i = 1; !names.insert(name).second; i++) {
+			name = base + "." + std::to_string(i);
+		}
+
+		info.sret = isAggregate(decl->type);
+		info.function = module.addFunction(name, info.sret ? IrType::VOID : irType(decl->type));
+
+		if(info.sret) {
+			module.addParam(info.function, IrType::PTR);
+		}
+		if(decl->params) {
+			for(AstVarDecl& param : decl->params->params) {
+				module.addParam(info.function, irType(param.type));
+			}
+		}
+		for(size_t i = 0; i < info.captures.size(); i++) {
+			module.addParam(info.function, IrType::PTR);
+		}
+	}
+}
+
+void IrLowering::beginFunction(IrFunction* function) {
+	context = Context();
+	context.function = function;
+	context.block = function->addBlock();
+}
+
+void IrLowering::endFunction() {
+	// falling off the end of a non-void function returns garbage
+	if(context.block->terminator() == nullptr) {
+		if(context.function->returnType == IrType::VOID) {
+			emit(IrOp::RET, IrType::VOID, {});
+		}
+		else {
+			emit(IrOp::RET, IrType::VOID, { module.undef(context.function->returnType) });
+		}
+	}
+
+	std::vector<IrInstr*>& entry = context.function->entry()->instrs;
+	entry.insert(entry.begin(), context.allocas.begin(), context.allocas.end());
+
+	context.function->orderBlocks();
+}
+
+void IrLowering::initGlobal(AstVarDecl* varDecl) {
+	IrGlobal* global = globals[varDecl];
+	ConstValue value;
+
+	if(!isAggregate(varDecl->type) && ConstFolder::evaluate(varDecl->expr, value)) {
+		switch(value.type) {
+			case AstType::CHAR: global->init = module.constant(IrType::CHAR, value.cvalue); break;
+			case AstType::BOOL: global->init = module.constant(IrType::BOOL, value.bvalue); break;
+			case AstType::FLOAT: global->init = module.constant(value.fvalue); break;
+			default: global->init = module.constant(IrType::INT, value.ivalue); break;
+		}
+		return;
+	}
+
+	// string literals and addresses of globals are known before the program runs
+	AstConstExpr* constExpr = dynamic_cast<AstConstExpr*>(varDecl->expr);
+	if(constExpr && constExpr->type == Token::STRING) {
+		global->init = lowerValue(constExpr);
+		return;
+	}
+
+	AstPrefixExpr* prefixExpr = dynamic_cast<AstPrefixExpr*>(varDecl->expr);
+	if(prefixExpr && prefixExpr->op == AstPrefixExpr::ADDR) {
+		AstNamedExpr* namedExpr = dynamic_cast<AstNamedExpr*>(prefixExpr->expr);
+		auto it = namedExpr ? globals.find((AstVarDecl*)namedExpr->declaration) : globals.end();
+
+		if(it != globals.end()) {
+			global->init = module.address(it->second);
+			return;
+		}
+	}
+
+	initializers.push_back(varDecl);
+}
+
+
+IrInstr* IrLowering::lowerValue(AstExpr* expr) {
+	address = false;
+	if(!expr->accept(this, Phase::BODY)) {
+		valid = false;
+	}
+	return result;
+}
+
+IrInstr* IrLowering::lowerAddress(AstExpr* expr) {
+	address = true;
+	if(!expr->accept(this, Phase::BODY)) {
+		valid = false;
+	}
+	return result;
+}
+
+void IrLowering::lowerStore(IrInstr* ptr, AstType* type, AstExpr* expr) {
+	IrInstr* value = lowerValue(expr);
+
+	if(isAggregate(type)) {
+		copy(ptr, value, type);
+	}
+	else {
+		emit(IrOp::STORE, IrType::VOID, { ptr, convert(value, irType(type)) });
+	}
+}
+
+IrInstr* IrLowering::lowerStep(AstExpr* expr, int delta, bool post) {
+	IrInstr* ptr = lowerAddress(expr);
+	AstType* type = Layout::resolve(expr->ofType);
+	IrInstr* old = emit(IrOp::LOAD, irType(type), { ptr });
+	IrInstr* value;
+
+	switch(type->type) {
+		case AstType::PTR:
+			value = emit(IrOp::ADDPTR, IrType::PTR, { old, scale(module.constant(IrType::INT, delta), ((AstPtrType*)type)->ptrType) });
+			break;
+		case AstType::FLOAT:
+			value = emit(IrOp::ADD, IrType::FLOAT, { old, module.constant((float)delta) });
+			break;
+		default:
+			value = emit(IrOp::ADD, old->type, { old, module.constant(old->type, delta) });
+			break;
+	}
+
+	emit(IrOp::STORE, IrType::VOID, { ptr, value });
+	return post ? old : value;
+}
+
+void IrLowering::access(IrInstr* ptr, AstType* type, bool wantAddress) {
+	result = (wantAddress || isAggregate(type)) ? ptr : emit(IrOp::LOAD, irType(type), { ptr });
+}
+
+void IrLowering::produce(IrInstr* value, AstType* type, bool wantAddress) {
+	if(wantAddress && !isAggregate(type) && value->type != IrType::VOID) {
+		IrInstr* ptr = allocate(type);
+		emit(IrOp::STORE, IrType::VOID, { ptr, value });
+		value = ptr;
+	}
+
+	result = value;
+}
+
+
+IrInstr* IrLowering::emit(IrOp op, IrType type, std::initializer_list<IrInstr*> operands) {
+	IrInstr* instr = module.create(op, type, operands.size());
+	std::copy(operands.begin(), operands.end(), instr->operands);
+	return context.block->append(instr);
+}
+
+void IrLowering::copy(IrInstr* destination, IrInstr* source, AstType* type) {
+	emit(IrOp::COPY, IrType::VOID, { destination, source })->ivalue = Layout::sizeOf(type);
+}
+
+IrInstr* IrLowering::convert(IrInstr* value, IrType type) {
+	if(value->type == type) {
+		return value;
+	}
+
+	// constants of mixed char and int operations are converted right away
+	if(value->op == IrOp::CONST && value->type != IrType::FLOAT && (type == IrType::INT || type == IrType::CHAR)) {
+		return module.constant(type, type == IrType::CHAR ? (char)value->ivalue : value->ivalue);
+	}
+	return emit(IrOp::CAST, type, { value });
+}
+
+IrInstr* IrLowering::scale(IrInstr* index, AstType* elementType) {
+	// void* steps by bytes
+	int size = Layout::sizeOf(elementType);
+	if(size <= 1) {
+		return index;
+	}
+	if(index->op == IrOp::CONST) {
+		return module.constant(IrType::INT, index->ivalue * size);
+	}
+	return emit(IrOp::MUL, IrType::INT, { index, module.constant(IrType::INT, size) });
+}
+
+IrInstr* IrLowering::allocate(AstType* type) {
+	int size = Layout::sizeOf(type);
+	int align = Layout::alignOf(type);
+
+	IrInstr* instr = module.create(IrOp::ALLOCA, IrType::PTR, 0);
+	instr->ivalue = size > 0 ? size : 1;
+	instr->align = align > 0 ? align : 1;
+	instr->block = context.function->entry();
+
+	context.allocas.push_back(instr);
+	return instr;
+}
+
+IrInstr* IrLowering::addressOf(AstVarDecl* varDecl) {
+	auto it = context.addresses.find(varDecl);
+	if(it != context.addresses.end()) {
+		return it->second;
+	}
+
+	auto global = globals.find(varDecl);
+	if(global != globals.end()) {
+		return module.address(global->second);
+	}
+
+	IrInstr* ptr = allocate(varDecl->type);
+	context.addresses[varDecl] = ptr;
+	return ptr;
+}
+
+void IrLowering::branch(IrBlock* target) {
+	IrInstr* instr = emit(IrOp::BR, IrType::VOID, {});
+	instr->targets = module.createTargets(1);
+	instr->targets[0] = target;
+}
+
+void IrLowering::branch(IrInstr* cond, IrBlock* ifTrue, IrBlock* ifFalse) {
+	IrInstr* instr = emit(IrOp::CONDBR, IrType::VOID, { cond });
+	instr->targets = module.createTargets(2);
+	instr->targets[0] = ifTrue;
+	instr->targets[1] = ifFalse;
+}
+
+
+bool IrLowering::visit(AstVarDecl* varDecl, Phase phase) {
+	// only globals get here in BODY, locals are lowered by their statement
+	if(phase == Phase::BODY) {
+		if(varDecl->expr) {
+			initGlobal(varDecl);
+		}
+		return true;
+	}
+
+	if(current) {
+		owners[varDecl] = current;
+	}
+	else {
+		int size = Layout::sizeOf(varDecl->type);
+		int align = Layout::alignOf(varDecl->type);
+		globals[varDecl] = module.addGlobal(varDecl->name, size > 0 ? size : 1, align > 0 ? align : 1);
+	}
+
+	return !varDecl->expr || varDecl->expr->accept(this, phase);
+}
+
+bool IrLowering::visit(AstParDecl* parDecl, Phase phase) {
+	return true;
+}
+
+bool IrLowering::visit(AstFunDecl* funDecl, Phase phase) {
+	if(phase == Phase::HEAD) {
+		FunctionInfo& info = functions[funDecl];
+		info.parent = current;
+		order.push_back(funDecl);
+
+		if(funDecl->params) {
+			for(AstVarDecl& param : funDecl->params->params) {
+				owners[&param] = funDecl;
+			}
+		}
+
+		if(!funDecl->body) {
+			return true;
+		}
+
+		AstFunDecl* parent = current;
+		current = funDecl;
+		bool result = funDecl->body->accept(this, phase);
+		current = parent;
+
+		return result;
+	}
+
+	if(!funDecl->body) {
+		return true;
+	}
+
+	FunctionInfo& info = functions[funDecl];
+	Context outer = std::move(context);
+	beginFunction(info.function);
+	context.decl = funDecl;
+
+	// scalar params are spilled so they can be assigned and have their address taken
+	size_t index = 0;
+	if(info.sret) {
+		context.sret = info.function->params[index++];
+	}
+	if(funDecl->params) {
+		for(AstVarDecl& param : funDecl->params->params) {
+			IrInstr* value = info.function->params[index++];
+
+			if(isAggregate(param.type)) {
+				context.addresses[&param] = value;
+			}
+			else {
+				emit(IrOp::STORE, IrType::VOID, { addressOf(&param), value });
+			}
+		}
+	}
+	for(AstVarDecl* capture : info.captures) {
+		context.addresses[capture] = info.function->params[index++];
+	}
+
+	bool result = funDecl->body->accept(this, phase);
+	endFunction();
+	context = std::move(outer);
+
+	return result;
+}
+
+bool IrLowering::visit(AstTypeDecl* typeDecl, Phase phase) {
+	return true;
+}
+
+bool IrLowering::visit(AstStructDecl* structDecl, Phase phase) {
+	return true;
+}
+
+
+bool IrLowering::visit(AstAtomType* atomType, Phase phase) {
+	return true;
+}
+
+bool IrLowering::visit(AstNamedType* namedType, Phase phase) {
+	return true;
+}
+
+bool IrLowering::visit(AstPtrType* ptrType, Phase phase) {
+	return true;
+}
+
+bool IrLowering::visit(AstArrayType* arrayType, Phase phase) {
+	return true;
+}
+
+
+bool IrLowering::visit(AstConstExpr* constExpr, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return true;
+	}
+
+	bool wantAddress = address;
+	IrInstr* value;
+
+	switch(constExpr->type) {
+		case Token::NUMBER:
+			value = module.constant(IrType::INT, constExpr->ivalue);
+			break;
+		case Token::CHARACTER:
+			value = module.constant(IrType::CHAR, constExpr->cvalue);
+			break;
+		case Token::TRUE:
+		case Token::FALSE:
+			value = module.constant(IrType::BOOL, constExpr->bvalue);
+			break;
+		case Token::FNUMBER:
+			value = module.constant(constExpr->fvalue);
+			break;
+		case Token::STRING: {
+			IrGlobal* global = module.addGlobal(".str." + std::to_string(strings++), constExpr->str.size() + 1, 1);
+			global->data = constExpr->str + '\0';
+			value = module.address(global);
+			break;
+		}
+		default:
+			Logger::getInstance().error("Cannot lower constant %s", constExpr->toString().c_str());
+			result = module.undef(irType(constExpr->ofType));
+			return false;
+	}
+
+	produce(value, constExpr->ofType, wantAddress);
+	return true;
+}
+
+bool IrLowering::visit(AstNamedExpr* namedExpr, Phase phase) {
+	AstVarDecl* decl = dynamic_cast<AstVarDecl*>(namedExpr->declaration);
+
+	if(phase == Phase::HEAD) {
+		// a local of an enclosing function
+		auto owner = decl ? owners.find(decl) : owners.end();
+		if(current && owner != owners.end() && owner->second != current) {
+			std::vector<AstVarDecl*>& captures = functions[current].captures;
+			if(std::find(captures.begin(), captures.end(), decl) == captures.end()) {
+				captures.push_back(decl);
+			}
+		}
+		return true;
+	}
+
+	if(decl == nullptr) {
+		Logger::getInstance().error("Cannot lower %s, it isn't a variable", namedExpr->name.c_str());
+		result = module.undef(irType(namedExpr->ofType));
+		return false;
+	}
+
+	access(addressOf(decl), namedExpr->ofType, address);
+	return true;
+}
+
+bool IrLowering::visit(AstCallExpr* callExpr, Phase phase) {
+	AstFunDecl* decl = dynamic_cast<AstFunDecl*>(callExpr->declaration);
+
+	if(phase == Phase::HEAD) {
+		bool result = true;
+		for(AstExpr* arg : callExpr->args) {
+			result = arg->accept(this, phase) && result;
+		}
+
+		if(current && decl) {
+			std::vector<AstFunDecl*>& callees = functions[current].callees;
+			if(std::find(callees.begin(), callees.end(), decl) == callees.end()) {
+				callees.push_back(decl);
+			}
+		}
+		return result;
+	}
+
+	bool wantAddress = address;
+
+	if(decl == nullptr || functions.count(decl) == 0) {
+		Logger::getInstance().error("Cannot lower call to %s, it isn't a function", callExpr->name.c_str());
+		result = module.undef(irType(callExpr->ofType));
+		return false;
+	}
+
+	FunctionInfo& info = functions[decl];
+	std::vector<IrInstr*> args;
+	IrInstr* returned = nullptr;
+
+	if(info.sret) {
+		returned = allocate(decl->type);
+		args.push_back(returned);
+	}
+
+	// structs and arrays are passed by value, the callee gets its own copy
+	for(AstExpr* arg : callExpr->args) {
+		IrInstr* value = lowerValue(arg);
+
+		if(isAggregate(arg->ofType)) {
+			IrInstr* temporary = allocate(arg->ofType);
+			copy(temporary, value, arg->ofType);
+			value = temporary;
+		}
+		args.push_back(convert(value, info.function->params[args.size()]->type));
+	}
+
+	for(AstVarDecl* capture : info.captures) {
+		args.push_back(addressOf(capture));
+	}
+
+	IrInstr* instr = module.create(IrOp::CALL, info.function->returnType, args.size());
+	std::copy(args.begin(), args.end(), instr->operands);
+	instr->callee = info.function;
+	context.block->append(instr);
+
+	if(returned) {
+		result = returned;
+	}
+	else {
+		produce(instr, callExpr->ofType, wantAddress);
+	}
+	return true;
+}
+
+bool IrLowering::visit(AstCastExpr* castExpr, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return castExpr->expr->accept(this, phase);
+	}
+
+	bool wantAddress = address;
+	IrInstr* value = lowerValue(castExpr->expr);
+
+	produce(convert(value, irType(castExpr->type)), castExpr->type, wantAddress);
+	return true;
+}
+
+bool IrLowering::visit(AstPrefixExpr* prefixExpr, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return prefixExpr->expr->accept(this, phase);
+	}
+
+	bool wantAddress = address;
+	IrType type = irType(prefixExpr->ofType);
+
+	switch(prefixExpr->op) {
+		case AstPrefixExpr::PLUS:
+			produce(lowerValue(prefixExpr->expr), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::MINUS:
+			produce(emit(IrOp::NEG, type, { lowerValue(prefixExpr->expr) }), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::NOT:
+			produce(emit(IrOp::NOT, type, { lowerValue(prefixExpr->expr) }), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::NEGATE:
+			produce(emit(IrOp::BNOT, type, { lowerValue(prefixExpr->expr) }), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::PPLUS:
+		case AstPrefixExpr::MMINUS:
+			produce(lowerStep(prefixExpr->expr, prefixExpr->op == AstPrefixExpr::PPLUS ? 1 : -1, false), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::DEREF:
+			access(lowerValue(prefixExpr->expr), prefixExpr->ofType, wantAddress);
+			break;
+		case AstPrefixExpr::ADDR:
+			produce(lowerAddress(prefixExpr->expr), prefixExpr->ofType, wantAddress);
+			break;
+	}
+
+	return true;
+}
+
+bool IrLowering::visit(AstPostfixExpr* postfixExpr, Phase phase) {
+	if(phase == Phase::HEAD) {
+		bool result = postfixExpr->expr->accept(this, phase);
+		if(postfixExpr->index) {
+			result = postfixExpr->index->accept(this, phase) && result;
+		}
+		return result;
+	}
+
+	bool wantAddress = address;
+
+	switch(postfixExpr->op) {
+		case AstPostfixExpr::PPLUS:
+		case AstPostfixExpr::MMINUS:
+			produce(lowerStep(postfixExpr->expr, postfixExpr->op == AstPostfixExpr::PPLUS ? 1 : -1, true), postfixExpr->ofType, wantAddress);
+			break;
+		case AstPostfixExpr::ACCESS:
+		case AstPostfixExpr::PTRACCESS: {
+			AstType* structType = postfixExpr->expr->ofType;
+			IrInstr* base;
+
+			if(postfixExpr->op == AstPostfixExpr::ACCESS) {
+				base = lowerAddress(postfixExpr->expr);
+			}
+			else {
+				base = lowerValue(postfixExpr->expr);
+				structType = ((AstPtrType*)Layout::resolve(structType))->ptrType;
+			}
+
+			int offset = Layout::structOf(structType)->offsets[postfixExpr->field];
+			IrInstr* ptr = offset == 0 ? base : emit(IrOp::ADDPTR, IrType::PTR, { base, module.constant(IrType::INT, offset) });
+
+			access(ptr, postfixExpr->ofType, wantAddress);
+			break;
+		}
+		case AstPostfixExpr::ARRAYACCESS: {
+			// arrays are indexed in place, pointers through their value
+			bool array = Layout::resolve(postfixExpr->expr->ofType)->type == AstType::ARRAY;
+			IrInstr* base = array ? lowerAddress(postfixExpr->expr) : lowerValue(postfixExpr->expr);
+			IrInstr* offset = scale(lowerValue(postfixExpr->index), postfixExpr->ofType);
+			IrInstr* ptr = (offset->op == IrOp::CONST && offset->ivalue == 0) ? base : emit(IrOp::ADDPTR, IrType::PTR, { base, offset });
+
+			access(ptr, postfixExpr->ofType, wantAddress);
+			break;
+		}
+	}
+
+	return true;
+}
+
+static IrOp binaryOp(AstBinaryExpr::Binary op) {
+	switch(op) {
+		case AstBinaryExpr::PLUS: return IrOp::ADD;
+		case AstBinaryExpr::MINUS: return IrOp::SUB;
+		case AstBinaryExpr::MUL: return IrOp::MUL;
+		case AstBinaryExpr::DIV: return IrOp::DIV;
+		case AstBinaryExpr::MOD: return IrOp::MOD;
+		case AstBinaryExpr::EQU: return IrOp::EQ;
+		case AstBinaryExpr::NEQ: return IrOp::NE;
+		case AstBinaryExpr::LESS: return IrOp::LT;
+		case AstBinaryExpr::LESS_EQU: return IrOp::LE;
+		case AstBinaryExpr::GREATER: return IrOp::GT;
+		case AstBinaryExpr::GREATER_EQU: return IrOp::GE;
+		case AstBinaryExpr::AND: return IrOp::AND;
+		case AstBinaryExpr::OR: return IrOp::OR;
+		default: return IrOp::XOR;
+	}
+}
+
+bool IrLowering::visit(AstBinaryExpr* binaryExpr, Phase phase) {
+	if(phase == Phase::HEAD) {
+		bool left = binaryExpr->left->accept(this, phase);
+		bool right = binaryExpr->right->accept(this, phase);
+		return left && right;
+	}
+
+	bool wantAddress = address;
+
+	// the right operand is only evaluated if the left one doesn't decide
+	if(binaryExpr->op == AstBinaryExpr::ANDAND || binaryExpr->op == AstBinaryExpr::OROR) {
+		bool isAnd = binaryExpr->op == AstBinaryExpr::ANDAND;
+		IrInstr* left = lowerValue(binaryExpr->left);
+		IrBlock* leftEnd = context.block;
+		IrBlock* rightBlock = context.function->addBlock();
+		IrBlock* end = context.function->addBlock();
+
+		branch(left, isAnd ? rightBlock : end, isAnd ? end : rightBlock);
+		startBlock(rightBlock);
+		IrInstr* right = lowerValue(binaryExpr->right);
+		IrBlock* rightEnd = context.block;
+		branch(end);
+		startBlock(end);
+
+		IrInstr* phi = module.create(IrOp::PHI, IrType::BOOL, 2);
+		phi->targets = module.createTargets(2);
+		phi->operands[0] = module.constant(IrType::BOOL, !isAnd);
+		phi->targets[0] = leftEnd;
+		phi->operands[1] = right;
+		phi->targets[1] = rightEnd;
+		context.block->append(phi);
+
+		produce(phi, binaryExpr->ofType, wantAddress);
+		return true;
+	}
+
+	AstType* leftType = Layout::resolve(binaryExpr->left->ofType);
+	AstType* rightType = Layout::resolve(binaryExpr->right->ofType);
+	IrInstr* left = lowerValue(binaryExpr->left);
+	IrInstr* right = lowerValue(binaryExpr->right);
+	IrOp op = binaryOp(binaryExpr->op);
+	IrType type = irType(binaryExpr->ofType);
+	IrInstr* value;
+
+	bool leftPtr = leftType->type == AstType::PTR;
+	bool rightPtr = rightType->type == AstType::PTR;
+
+	if((op == IrOp::ADD || op == IrOp::SUB) && leftPtr != rightPtr) {
+		// pointer arithmetic moves by whole elements
+		IrInstr* ptr = leftPtr ? left : right;
+		AstType* pointee = ((AstPtrType*)(leftPtr ? leftType : rightType))->ptrType;
+		IrInstr* offset = scale(leftPtr ? right : left, pointee);
+
+		if(op == IrOp::SUB) {
+			offset = emit(IrOp::NEG, IrType::INT, { offset });
+		}
+		value = emit(IrOp::ADDPTR, IrType::PTR, { ptr, offset });
+	}
+	else if(op >= IrOp::EQ && op <= IrOp::GE) {
+		value = emit(op, IrType::BOOL, { left, right });
+	}
+	else {
+		// mixed char and int is computed as char, anything else on pointers as int
+		IrType operandType = type == IrType::PTR ? IrType::INT : type;
+		value = emit(op, operandType, { convert(left, operandType), convert(right, operandType) });
+		value = convert(value, type);
+	}
+
+	produce(value, binaryExpr->ofType, wantAddress);
+	return true;
+}
+
+bool IrLowering::visit(AstSizeofExpr* sizeofExpr, Phase phase) {
+	if(phase == Phase::BODY) {
+		produce(module.constant(IrType::INT, sizeofExpr->size), sizeofExpr->ofType, address);
+	}
+	return true;
+}
+
+
+bool IrLowering::visit(AstExprStmt* exprStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return exprStmt->expr->accept(this, phase);
+	}
+
+	lowerValue(exprStmt->expr);
+	return true;
+}
+
+bool IrLowering::visit(AstAssignStmt* assignStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		bool left = assignStmt->left->accept(this, phase);
+		bool right = assignStmt->right->accept(this, phase);
+		return left && right;
+	}
+
+	IrInstr* ptr = lowerAddress(assignStmt->left);
+
+	if(assignStmt->op == AstAssignStmt::EQU) {
+		lowerStore(ptr, assignStmt->left->ofType, assignStmt->right);
+		return true;
+	}
+
+	IrOp op;
+	switch(assignStmt->op) {
+		case AstAssignStmt::PLUS: op = IrOp::ADD; break;
+		case AstAssignStmt::MINUS: op = IrOp::SUB; break;
+		case AstAssignStmt::MUL: op = IrOp::MUL; break;
+		case AstAssignStmt::DIV: op = IrOp::DIV; break;
+		default: op = IrOp::MOD; break;
+	}
+
+	IrType type = irType(assignStmt->left->ofType);
+	IrInstr* old = emit(IrOp::LOAD, type, { ptr });
+	IrInstr* value = convert(lowerValue(assignStmt->right), type);
+
+	emit(IrOp::STORE, IrType::VOID, { ptr, emit(op, type, { old, value }) });
+	return true;
+}
+
+bool IrLowering::visit(AstCompStmt* compStmt, Phase phase) {
+	bool result = true;
+
+	for(AstStmt* stmt : compStmt->stmts) {
+		result = stmt->accept(this, phase) && result;
+	}
+
+	return result;
+}
+
+bool IrLowering::visit(AstIfStmt* ifStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		bool result = ifStmt->cond->accept(this, phase);
+		result = ifStmt->stmt->accept(this, phase) && result;
+		if(ifStmt->elseStmt) {
+			result = ifStmt->elseStmt->accept(this, phase) && result;
+		}
+		return result;
+	}
+
+	IrInstr* cond = lowerValue(ifStmt->cond);
+	IrBlock* then = context.function->addBlock();
+	IrBlock* otherwise = ifStmt->elseStmt ? context.function->addBlock() : nullptr;
+	IrBlock* end = context.function->addBlock();
+
+	branch(cond, then, otherwise ? otherwise : end);
+
+	startBlock(then);
+	bool result = ifStmt->stmt->accept(this, phase);
+	branch(end);
+
+	if(otherwise) {
+		startBlock(otherwise);
+		result = ifStmt->elseStmt->accept(this, phase) && result;
+		branch(end);
+	}
+
+	startBlock(end);
+	return result;
+}
+
+bool IrLowering::visit(AstWhileStmt* whileStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		bool result = whileStmt->cond->accept(this, phase);
+		return whileStmt->stmt->accept(this, phase) && result;
+	}
+
+	IrBlock* header = context.function->addBlock();
+	IrBlock* body = context.function->addBlock();
+	IrBlock* end = context.function->addBlock();
+
+	branch(header);
+	startBlock(header);
+	branch(lowerValue(whileStmt->cond), body, end);
+
+	startBlock(body);
+	bool result = whileStmt->stmt->accept(this, phase);
+	branch(header);
+
+	startBlock(end);
+	return result;
+}
+
+bool IrLowering::visit(AstReturnStmt* returnStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return !returnStmt->expr || returnStmt->expr->accept(this, phase);
+	}
+
+	if(returnStmt->expr == nullptr) {
+		emit(IrOp::RET, IrType::VOID, {});
+	}
+	else if(context.sret) {
+		copy(context.sret, lowerValue(returnStmt->expr), returnStmt->funDecl->type);
+		emit(IrOp::RET, IrType::VOID, {});
+	}
+	else {
+		emit(IrOp::RET, IrType::VOID, { convert(lowerValue(returnStmt->expr), context.function->returnType) });
+	}
+
+	// code after a return is unreachable, orderBlocks drops its block
+	startBlock(context.function->addBlock());
+	return true;
+}
+
+bool IrLowering::visit(AstVarStmt* varStmt, Phase phase) {
+	if(phase == Phase::HEAD) {
+		return varStmt->decl.accept(this, phase);
+	}
+
+	IrInstr* ptr = addressOf(&varStmt->decl);
+	if(varStmt->decl.expr) {
+		lowerStore(ptr, varStmt->decl.type, varStmt->decl.expr);
+	}
+	return true;
+}
+
+bool IrLowering::visit(AstFunStmt* funStmt, Phase phase) {
+	return funStmt->decl->accept(this, phase);
+}
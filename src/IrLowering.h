@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <initializer_list>
+#include "Visitor.h"
+#include "Ast.h"
+#include "Ir.h"
+#include "Logger.h"
+
+// Lowers the typed AST into the IR. HEAD collects every function with the locals it
+// owns, the outer locals it uses and the functions it calls. BODY emits the code.
+//
+// Nested functions are lifted to the top level, named outer.inner, and get the
+// addresses of the outer locals they use (directly or through their callees) as
+// extra parameters after their own. Structs and arrays are passed by copying them
+// into a temporary of the caller, and returned through a hidden first parameter
+// pointing to the caller's temporary.
+class IrLowering : public Visitor {
+private:
+	struct FunctionInfo {
+		IrFunction* function = nullptr;
+		AstFunDecl* parent = nullptr;
+		bool sret = false;						// returns a struct or array through params[0]
+		std::vector<AstVarDecl*> captures;		// outer locals, passed by address
+		std::vector<AstFunDecl*> callees;
+	};
+
+	// state of the function being emitted, nested functions save and restore it
+	struct Context {
+		AstFunDecl* decl = nullptr;
+		IrFunction* function = nullptr;
+		IrBlock* block = nullptr;
+		IrInstr* sret = nullptr;
+		std::vector<IrInstr*> allocas;			// moved to the front of the entry block when done
+		std::unordered_map<AstVarDecl*, IrInstr*> addresses;
+	};
+
+	IrModule& module;
+	std::unordered_map<AstFunDecl*, FunctionInfo> functions;
+	std::vector<AstFunDecl*> order;				// functions in source order, parents first
+	std::unordered_map<AstVarDecl*, AstFunDecl*> owners;
+	std::unordered_map<AstVarDecl*, IrGlobal*> globals;
+	AstFunDecl* current = nullptr;				// HEAD: function being scanned
+
+	Context context;
+	std::vector<AstVarDecl*> initializers;		// non-constant globals, stored by .init
+	bool address = false;						// the visited expression should yield its address
+	IrInstr* result = nullptr;					// value or address of the last visited expression
+	int strings = 0;
+	bool valid = true;
+
+	void resolveCaptures();
+	void declareFunctions();
+	void beginFunction(IrFunction* function);
+	void endFunction();
+	void initGlobal(AstVarDecl* varDecl);
+
+	IrInstr* lowerValue(AstExpr* expr);
+	IrInstr* lowerAddress(AstExpr* expr);
+	void lowerStore(IrInstr* ptr, AstType* type, AstExpr* expr);
+	IrInstr* lowerStep(AstExpr* expr, int delta, bool post);	// ++ and --
+
+	// value or address of an lvalue at ptr, depending on what was asked for
+	void access(IrInstr* ptr, AstType* type, bool wantAddress);
+	// an rvalue, spilled to memory if its address was asked for
+	void produce(IrInstr* value, AstType* type, bool wantAddress);
+
+	IrInstr* emit(IrOp op, IrType type, std::initializer_list<IrInstr*> operands);
+	void copy(IrInstr* destination, IrInstr* source, AstType* type);
+	IrInstr* convert(IrInstr* value, IrType type);
+	IrInstr* scale(IrInstr* index, AstType* elementType);
+	IrInstr* allocate(AstType* type);
+	IrInstr* addressOf(AstVarDecl* varDecl);	// allocates locals on first use
+	void branch(IrBlock* target);
+	void branch(IrInstr* cond, IrBlock* ifTrue, IrBlock* ifFalse);
+	void startBlock(IrBlock* block) { context.block = block; }
+
+	static IrType irType(AstType* type);
+	static bool isAggregate(AstType* type);
+
+public:
+	IrLowering(IrModule& module) : module(module) {
+		Logger::getInstance().log("#i#grnPhase 4: IR lowering#r\n");
+	}
+
+	bool lower(std::vector<AstDecl*>& decls);
+
+	bool visit(AstVarDecl* varDecl, Phase phase) override;
+	bool visit(AstParDecl* parDecl, Phase phase) override;
+	bool visit(AstFunDecl* funDecl, Phase phase) override;
+	bool visit(AstTypeDecl* typeDecl, Phase phase) override;
+	bool visit(AstStructDecl* structDecl, Phase phase) override;
+
+	bool visit(AstAtomType* atomType, Phase phase) override;
+	bool visit(AstNamedType* namedType, Phase phase) override;
+	bool visit(AstPtrType* ptrType, Phase phase) override;
+	bool visit(AstArrayType* arrayType, Phase phase) override;
+
+	bool visit(AstConstExpr* constExpr, Phase phase) override;
+	bool visit(AstNamedExpr* namedExpr, Phase phase) override;
+	bool visit(AstCallExpr* callExpr, Phase phase) override;
+	bool visit(AstCastExpr* castExpr, Phase phase) override;
+	bool visit(AstPrefixExpr* prefixExpr, Phase phase) override;
+	bool visit(AstPostfixExpr* postfixExpr, Phase phase) override;
+	bool visit(AstBinaryExpr* binaryExpr, Phase phase) override;
+	bool visit(AstSizeofExpr* sizeofExpr, Phase phase) override;
+
+	bool visit(AstExprStmt* exprStmt, Phase phase) override;
+	bool visit(AstAssignStmt* assignStmt, Phase phase) override;
+	bool visit(AstCompStmt* compStmt, Phase phase) override;
+	bool visit(AstIfStmt* ifStmt, Phase phase) override;
+	bool visit(AstWhileStmt* whileStmt, Phase phase) override;
+	bool visit(AstReturnStmt* returnStmt, Phase phase) override;
+	bool visit(AstVarStmt* varStmt, Phase phase) override;
+	bool visit(AstFunStmt* funStmt, Phase phase) override;
+};
@@ -0,0 +1,93 @@
+#include "IrOptimizer.h"
+#include "IrPromoter.h"
+#include "IrConstProp.h"
+#include "IrValueNumbering.h"
+#include "IrDeadCode.h"
+#include "Timer.h"
+
+void IrOptimizer::optimize() {
+	run("mem2reg", &IrOptimizer::promote);
+	run("constant propagation", &IrOptimizer::propagate);
+	run("value numbering", &IrOptimizer::numberValues);
+	run("dead code elimination", &IrOptimizer::removeDeadCode);
+
+	if(report) {
+		printReport();
+	}
+}
+
+void IrOptimizer::run(const char* name, void (IrOptimizer::*pass)()) {
+	ScopedTimer timer(name);
+	size_t before = module.getInstrCount();
+
+	(this->*pass)();
+
+	timer.count(before, "instructions");
+	steps.push_back({ name, before, module.getInstrCount() });
+}
+
+void IrOptimizer::printReport() const {
+	Logger& logger = Logger::getInstance();
+
+	logger.log("#i#grnOptimization report#r\n");
+	logger.log("%-24s %12s %12s %8s", "pass", "before", "after", "change");
+
+	for(const Step& step : steps) {
+		double change = step.before > 0 ? 100.0 * ((double)step.after - (double)step.before) / step.before : 0;
+		logger.log("%-24s %12zu %12zu %7.1f%%", step.pass, step.before, step.after, change);
+	}
+
+	if(!steps.empty()) {
+		double change = steps.front().before > 0 ? 100.0 * ((double)steps.back().after - (double)steps.front().before) / steps.front().before : 0;
+		logger.log("%-24s %12zu %12zu %7.1f%%", "total", steps.front().before, steps.back().after, change);
+	}
+}
+
+size_t IrOptimizer::getBlockCount() const {
+	size_t count = 0;
+	for(auto& function : module.functions) {
+		count += function->blocks.size();
+	}
+	return count;
+}
+
+void IrOptimizer::promote() {
+	for(auto& function : module.functions) {
+		size_t count = IrPromoter(module, *function).run();
+		if(count > 0) {
+			LOG_DEBUG("Promoted %zu locals in @%s", count, function->name.c_str());
+		}
+	}
+}
+
+void IrOptimizer::propagate() {
+	size_t instrs = module.getInstrCount();
+	size_t blocks = getBlockCount();
+
+	std::unordered_set<const IrGlobal*> constants = IrConstProp::findConstantGlobals(module);
+	for(auto& function : module.functions) {
+		IrConstProp(module, *function, constants).run();
+	}
+
+	Logger::getInstance().log("Constant propagation removed %zu instructions and %zu blocks", instrs - module.getInstrCount(), blocks - getBlockCount());
+}
+
+void IrOptimizer::numberValues() {
+	for(auto& function : module.functions) {
+		size_t count = IrValueNumbering(*function).run();
+		if(count > 0) {
+			LOG_DEBUG("Removed %zu redundant instructions in @%s", count, function->name.c_str());
+		}
+	}
+}
+
+void IrOptimizer::removeDeadCode() {
+	size_t instrs = module.getInstrCount();
+
+	for(auto& function : module.functions) {
+		IrDeadCode(*function).run();
+	}
+	size_t functions = IrDeadCode::removeDeadFunctions(module);
+
+	Logger::getInstance().log("Dead code elimination removed %zu instructions and %zu functions", instrs - module.getInstrCount(), functions);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "Ir.h"
+#include "Logger.h"
+
+// Runs the optimization passes over every defined function of a module, each pass
+// timed as a phase of its own
+class IrOptimizer {
+private:
+	// instructions before and after a pass, for --opt-report
+	struct Step {
+		const char* pass;
+		size_t before;
+		size_t after;
+	};
+
+	IrModule& module;
+	bool report;
+	std::vector<Step> steps;
+
+	void run(const char* name, void (IrOptimizer::*pass)());
+	void printReport() const;
+	size_t getBlockCount() const;
+
+	void promote();
+	void propagate();
+	void numberValues();
+	void removeDeadCode();
+
+public:
+	IrOptimizer(IrModule& module, bool report = false) : module(module), report(report) {
+		Logger::getInstance().log("#i#grnPhase 5: IR optimization#r\n");
+	}
+
+	void optimize();
+};
@@ -0,0 +1,304 @@
+#include "IrPromoter.h"
+#include "IrCfg.h"
+
+bool IrPromoter::isPromoted(IrInstr* instr) const {
+	switch(instr->op) {
+		case IrOp::ALLOCA:
+			return variableOf.count(instr) > 0;
+		case IrOp::LOAD:
+		case IrOp::STORE:
+			return instr->operands[0]->op == IrOp::ALLOCA && variableOf.count(instr->operands[0]) > 0;
+		case IrOp::PHI:
+			return trivial.count(instr) > 0;
+		default:
+			return false;
+	}
+}
+
+IrInstr* IrPromoter::resolve(IrInstr* value) const {
+	for(auto it = replacements.find(value); it != replacements.end(); it = replacements.find(value)) {
+		value = it->second;
+	}
+	return value;
+}
+
+IrInstr* IrPromoter::current(unsigned variable) {
+	// a load no store reaches reads garbage
+	Variable& var = variables[variable];
+
+	if(!var.values.empty()) {
+		return var.values.back();
+	}
+	if(var.undef == nullptr) {
+		var.undef = module.undef(var.type);
+	}
+	return var.undef;
+}
+
+size_t IrPromoter::run() {
+	if(function.isDeclaration()) {
+		return 0;
+	}
+
+	findVariables();
+	if(variables.empty()) {
+		return 0;
+	}
+
+	unsigned blockCount = function.blocks.size();
+	phis.assign(blockCount, {});
+	live.assign(blockCount, IrCfg::NONE);
+	placed.assign(blockCount, IrCfg::NONE);
+	defined.assign(blockCount, IrCfg::NONE);
+
+	for(unsigned i = 0; i < variables.size(); i++) {
+		placePhis(i);
+	}
+
+	rename();
+	removeTrivialPhis();
+
+	for(unsigned block = 0; block < blockCount; block++) {
+		std::vector<IrInstr*>& instrs = function.blocks[block]->instrs;
+		for(IrInstr* phi : phis[block]) {
+			phi->block = function.blocks[block].get();
+		}
+		instrs.insert(instrs.begin(), phis[block].begin(), phis[block].end());
+	}
+
+	function.removeInstrs([this](IrInstr* instr) { return isPromoted(instr); });
+	function.replaceUses(replacements);
+
+	return variables.size();
+}
+
+void IrPromoter::findVariables() {
+	std::unordered_map<IrInstr*, IrType> types;
+	std::unordered_set<IrInstr*> escaped;
+
+	for(IrInstr* instr : function.entry()->instrs) {
+		if(instr->op == IrOp::ALLOCA) {
+			types[instr] = IrType::VOID;
+		}
+	}
+
+	// every use has to be the address of a load or store of one type
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			for(unsigned i = 0; i < instr->count; i++) {
+				auto it = types.find(instr->operands[i]);
+				if(it == types.end()) {
+					continue;
+				}
+
+				IrType type = instr->op == IrOp::LOAD ? instr->type : instr->operands[instr->count - 1]->type;
+				bool access = i == 0 && (instr->op == IrOp::LOAD || instr->op == IrOp::STORE);
+
+				if(!access || (it->second != IrType::VOID && it->second != type)) {
+					escaped.insert(it->first);
+				}
+				it->second = type;
+			}
+		}
+	}
+
+	for(IrInstr* instr : function.entry()->instrs) {
+		if(instr->op != IrOp::ALLOCA || escaped.count(instr)) {
+			continue;
+		}
+
+		// e.g. an int stored into the first bytes of a struct
+		IrType type = types[instr];
+		if(type != IrType::VOID && IrModule::typeSize(type) != instr->ivalue) {
+			continue;
+		}
+
+		variableOf[instr] = variables.size();
+		variables.push_back({ instr, type, {}, {}, {}, nullptr });
+	}
+
+	// stores and loads that come before any store in the same block
+	std::vector<unsigned> stored(variables.size(), IrCfg::NONE);
+	std::vector<unsigned> loaded(variables.size(), IrCfg::NONE);
+
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			if((instr->op != IrOp::LOAD && instr->op != IrOp::STORE) || !isPromoted(instr)) {
+				continue;
+			}
+
+			unsigned variable = variableOf[instr->operands[0]];
+
+			if(instr->op == IrOp::STORE && stored[variable] != block->id) {
+				stored[variable] = block->id;
+				variables[variable].defBlocks.push_back(block->id);
+			}
+			else if(instr->op == IrOp::LOAD && stored[variable] != block->id && loaded[variable] != block->id) {
+				loaded[variable] = block->id;
+				variables[variable].useBlocks.push_back(block->id);
+			}
+		}
+	}
+}
+
+void IrPromoter::placePhis(unsigned variable) {
+	const IrCfg& cfg = function.cfg();
+	Variable& var = variables[variable];
+
+	// live-in blocks, walking back from the loads up to the stores that reach them
+	std::vector<unsigned> worklist = var.useBlocks;
+
+	for(unsigned block : var.defBlocks) {
+		defined[block] = variable;
+	}
+	for(unsigned block : worklist) {
+		live[block] = variable;
+	}
+
+	while(!worklist.empty()) {
+		unsigned block = worklist.back();
+		worklist.pop_back();
+
+		for(unsigned pred : cfg.predecessors(block)) {
+			if(live[pred] != variable && defined[pred] != variable) {
+				live[pred] = variable;
+				worklist.push_back(pred);
+			}
+		}
+	}
+
+	// a phi is a store of its own, so its frontier may need one too
+	worklist = var.defBlocks;
+
+	while(!worklist.empty()) {
+		unsigned block = worklist.back();
+		worklist.pop_back();
+
+		for(unsigned join : cfg.frontier(block)) {
+			if(placed[join] == variable) {
+				continue;
+			}
+			placed[join] = variable;
+
+			if(live[join] != variable) {
+				continue;
+			}
+
+			IrCfg::Range preds = cfg.predecessors(join);
+			IrInstr* phi = module.create(IrOp::PHI, var.type, preds.size());
+			phi->targets = module.createTargets(preds.size());
+
+			for(size_t i = 0; i < preds.size(); i++) {
+				phi->targets[i] = function.blocks[preds[i]].get();
+			}
+
+			phis[join].push_back(phi);
+			variableOf[phi] = variable;
+
+			if(defined[join] != variable) {
+				defined[join] = variable;
+				worklist.push_back(join);
+			}
+		}
+	}
+}
+
+void IrPromoter::rename() {
+	const IrCfg& cfg = function.cfg();
+
+	// variables given a new value by each open block, undone when it is left
+	std::vector<unsigned> pushed;
+	std::vector<std::pair<unsigned, size_t>> stack { { 0, 0 } };	// block, size of pushed when entered, NONE when leaving
+
+	while(!stack.empty()) {
+		unsigned block = stack.back().first;
+		size_t mark = stack.back().second;
+		stack.pop_back();
+
+		if(block == IrCfg::NONE) {
+			for(; pushed.size() > mark; pushed.pop_back()) {
+				variables[pushed.back()].values.pop_back();
+			}
+			continue;
+		}
+
+		mark = pushed.size();
+		IrBlock* irBlock = function.blocks[block].get();
+
+		for(IrInstr* phi : phis[block]) {
+			unsigned variable = variableOf[phi];
+			variables[variable].values.push_back(phi);
+			pushed.push_back(variable);
+		}
+
+		for(IrInstr* instr : irBlock->instrs) {
+			if((instr->op != IrOp::LOAD && instr->op != IrOp::STORE) || !isPromoted(instr)) {
+				continue;
+			}
+
+			unsigned variable = variableOf[instr->operands[0]];
+
+			if(instr->op == IrOp::LOAD) {
+				replacements[instr] = current(variable);
+			}
+			else {
+				variables[variable].values.push_back(resolve(instr->operands[1]));
+				pushed.push_back(variable);
+			}
+		}
+
+		for(unsigned successor : cfg.successors(block)) {
+			for(IrInstr* phi : phis[successor]) {
+				for(unsigned i = 0; i < phi->count; i++) {
+					if(phi->targets[i] == irBlock) {
+						phi->operands[i] = current(variableOf[phi]);
+					}
+				}
+			}
+		}
+
+		stack.push_back({ IrCfg::NONE, mark });
+		for(unsigned child : cfg.domChildren(block)) {
+			stack.push_back({ child, 0 });
+		}
+	}
+}
+
+void IrPromoter::removeTrivialPhis() {
+	// a phi merging one value and itself is that value, which can make another phi trivial
+	bool changed = true;
+
+	while(changed) {
+		changed = false;
+
+		for(std::vector<IrInstr*>& blockPhis : phis) {
+			for(IrInstr* phi : blockPhis) {
+				if(trivial.count(phi)) {
+					continue;
+				}
+
+				IrInstr* same = nullptr;
+				bool unique = true;
+
+				for(unsigned i = 0; i < phi->count && unique; i++) {
+					IrInstr* value = resolve(phi->operands[i]);
+					if(value == phi || value == same) {
+						continue;
+					}
+					unique = same == nullptr;
+					same = value;
+				}
+
+				if(unique && same) {
+					replacements[phi] = same;
+					trivial.insert(phi);
+					changed = true;
+				}
+			}
+		}
+	}
+
+	for(std::vector<IrInstr*>& blockPhis : phis) {
+		blockPhis.erase(std::remove_if(blockPhis.begin(), blockPhis.end(), [this](IrInstr* phi) { return trivial.count(phi) > 0; }), blockPhis.end());
+	}
+}
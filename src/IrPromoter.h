@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "Ir.h"
+
+// Promotes locals to SSA values (mem2reg). An alloca qualifies if it is only ever loaded
+// from and stored to, always as the same type. Taking its address with &, passing it to
+// a nested function or indexing into it all use the alloca as a value and keep it in
+// memory. Phis go on the iterated dominance frontier of the stores, but only where the
+// variable is live, then a walk down the dominator tree gives every load its value.
+class IrPromoter {
+private:
+	struct Variable {
+		IrInstr* alloca;
+		IrType type = IrType::VOID;
+		std::vector<unsigned> defBlocks;	// blocks storing to it
+		std::vector<unsigned> useBlocks;	// blocks loading it before storing
+		std::vector<IrInstr*> values;		// reaching definitions while renaming
+		IrInstr* undef = nullptr;
+	};
+
+	IrModule& module;
+	IrFunction& function;
+	std::vector<Variable> variables;
+	std::unordered_map<IrInstr*, unsigned> variableOf;	// by alloca and by inserted phi
+	std::vector<std::vector<IrInstr*>> phis;			// inserted phis of every block
+	std::unordered_map<IrInstr*, IrInstr*> replacements;
+	std::unordered_set<IrInstr*> trivial;				// phis that turned out to merge one value
+
+	// per block, the last variable it was marked for, so they aren't cleared between variables
+	std::vector<unsigned> live;
+	std::vector<unsigned> placed;
+	std::vector<unsigned> defined;
+
+	bool isPromoted(IrInstr* instr) const;
+	IrInstr* resolve(IrInstr* value) const;
+	IrInstr* current(unsigned variable);
+
+	void findVariables();
+	void placePhis(unsigned variable);
+	void rename();
+	void removeTrivialPhis();
+
+public:
+	IrPromoter(IrModule& module, IrFunction& function) : module(module), function(function) {}
+
+	// returns the number of promoted allocas
+	size_t run();
+};
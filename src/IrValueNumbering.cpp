@@ -0,0 +1,252 @@
+#include "IrValueNumbering.h"
+#include <algorithm>
+#include "IrCfg.h"
+
+bool IrValueNumbering::Expression::operator==(const Expression& other) const {
+	if(op != other.op || type != other.type || count != other.count) {
+		return false;
+	}
+	for(unsigned i = 0; i < count; i++) {
+		if(!(operands[i] == other.operands[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t IrValueNumbering::ExpressionHash::operator()(const Expression& expression) const {
+	size_t hash = (size_t)expression.op * 31 + (size_t)expression.type;
+	for(unsigned i = 0; i < expression.count; i++) {
+		hash = hash * 1000003 ^ (expression.operands[i].value * 8 + expression.operands[i].kind);
+	}
+	return hash;
+}
+
+size_t IrValueNumbering::run() {
+	if(function.isDeclaration()) {
+		return 0;
+	}
+
+	findEscapes();
+
+	// preorder walk of the dominator tree, NONE closes the scope opened at mark
+	const IrCfg& cfg = function.cfg();
+	std::vector<std::pair<unsigned, size_t>> stack { { 0, 0 } };
+
+	while(!stack.empty()) {
+		unsigned block = stack.back().first;
+		size_t mark = stack.back().second;
+		stack.pop_back();
+
+		if(block == IrCfg::NONE) {
+			for(; scope.size() > mark; scope.pop_back()) {
+				table.erase(scope.back());
+			}
+			continue;
+		}
+
+		stack.push_back({ IrCfg::NONE, scope.size() });
+		numberBlock(function.blocks[block].get());
+
+		for(unsigned child : cfg.domChildren(block)) {
+			stack.push_back({ child, 0 });
+		}
+	}
+
+	function.removeInstrs([this](IrInstr* instr) { return replacements.count(instr) > 0; });
+	function.replaceUses(replacements);
+	return removed;
+}
+
+IrInstr* IrValueNumbering::leader(IrInstr* value) const {
+	for(auto it = replacements.find(value); it != replacements.end(); it = replacements.find(value)) {
+		value = it->second;
+	}
+	return value;
+}
+
+IrValueNumbering::Operand IrValueNumbering::operandOf(IrInstr* value) const {
+	// constants and global addresses are new values every time they are used
+	if(value->op == IrOp::CONST) {
+		return { 1, (uint64_t)value->type << 32 | (uint32_t)value->ivalue };
+	}
+	if(value->op == IrOp::GLOBAL) {
+		return { 2, (uint64_t)(uintptr_t)value->global };
+	}
+	return { 0, (uint64_t)(uintptr_t)leader(value) };
+}
+
+bool IrValueNumbering::makeExpression(IrInstr* instr, Expression& expression) const {
+	bool pure = (instr->op >= IrOp::ADD && instr->op <= IrOp::GE) || instr->op == IrOp::CAST || instr->op == IrOp::ADDPTR;
+	if(!pure || instr->count > 2) {
+		return false;
+	}
+
+	expression.op = instr->op;
+	expression.type = instr->type;
+	expression.count = instr->count;
+	for(unsigned i = 0; i < instr->count; i++) {
+		expression.operands[i] = operandOf(instr->operands[i]);
+	}
+
+	switch(instr->op) {
+		case IrOp::GT:
+			expression.op = IrOp::LT;
+			std::swap(expression.operands[0], expression.operands[1]);
+			break;
+		case IrOp::GE:
+			expression.op = IrOp::LE;
+			std::swap(expression.operands[0], expression.operands[1]);
+			break;
+		case IrOp::ADD:
+		case IrOp::MUL:
+		case IrOp::AND:
+		case IrOp::OR:
+		case IrOp::XOR:
+		case IrOp::EQ:
+		case IrOp::NE:
+			if(expression.operands[1] < expression.operands[0]) {
+				std::swap(expression.operands[0], expression.operands[1]);
+			}
+			break;
+		default:
+			break;
+	}
+
+	return true;
+}
+
+void IrValueNumbering::findEscapes() {
+	// an alloca stays private while its address, or one computed from it, is only accessed
+	for(auto& block : function.blocks) {
+		for(IrInstr* instr : block->instrs) {
+			for(unsigned i = 0; i < instr->count; i++) {
+				IrInstr* base = locate(instr->operands[i], 0).base;
+				if(base->op != IrOp::ALLOCA) {
+					continue;
+				}
+
+				bool access = (i == 0 && (instr->op == IrOp::LOAD || instr->op == IrOp::STORE || instr->op == IrOp::ADDPTR))
+					|| instr->op == IrOp::COPY;
+				if(!access) {
+					escaped.insert(base);
+				}
+			}
+		}
+	}
+}
+
+IrValueNumbering::Location IrValueNumbering::locate(IrInstr* address, int size) const {
+	Location location { address, address, 0, true, size };
+
+	while(location.base->op == IrOp::ADDPTR) {
+		IrInstr* offset = location.base->operands[1];
+		if(offset->op == IrOp::CONST) {
+			location.offset += offset->ivalue;
+		}
+		else {
+			location.known = false;
+		}
+		location.base = location.base->operands[0];
+	}
+
+	return location;
+}
+
+bool IrValueNumbering::sameBase(const IrInstr* a, const IrInstr* b) {
+	return a == b || (a->op == IrOp::GLOBAL && b->op == IrOp::GLOBAL && a->global == b->global);
+}
+
+bool IrValueNumbering::isPrivate(const IrInstr* base) const {
+	return base->op == IrOp::ALLOCA && !escaped.count(base);
+}
+
+bool IrValueNumbering::mayAlias(const Location& a, const Location& b) const {
+	bool identifiedA = a.base->op == IrOp::ALLOCA || a.base->op == IrOp::GLOBAL;
+	bool identifiedB = b.base->op == IrOp::ALLOCA || b.base->op == IrOp::GLOBAL;
+
+	if(sameBase(a.base, b.base)) {
+		if(a.known && b.known) {
+			return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+		}
+		return true;
+	}
+	if(identifiedA && identifiedB) {
+		return false;
+	}
+
+	// some other pointer, which can't point into a private alloca
+	return !isPrivate(a.base) && !isPrivate(b.base);
+}
+
+void IrValueNumbering::clobber(const Location* location) {
+	loads.erase(std::remove_if(loads.begin(), loads.end(), [this, location](const KnownLoad& load) {
+		return location ? mayAlias(*location, load.location) : !isPrivate(load.location.base);
+	}), loads.end());
+}
+
+void IrValueNumbering::numberBlock(IrBlock* block) {
+	loads.clear();
+
+	for(IrInstr* instr : block->instrs) {
+		// values from back edges of phis are fixed up by replaceUses
+		for(unsigned i = 0; i < instr->count; i++) {
+			instr->operands[i] = leader(instr->operands[i]);
+		}
+
+		Expression expression;
+		if(makeExpression(instr, expression)) {
+			auto it = table.find(expression);
+			if(it != table.end()) {
+				replacements[instr] = it->second;
+				removed++;
+			}
+			else {
+				table[expression] = instr;
+				scope.push_back(expression);
+			}
+			continue;
+		}
+
+		switch(instr->op) {
+			case IrOp::LOAD:
+				numberLoad(instr);
+				break;
+			case IrOp::STORE: {
+				// the stored value is what a load reads back
+				IrType type = instr->operands[1]->type;
+				Location location = locate(instr->operands[0], IrModule::typeSize(type));
+				clobber(&location);
+				loads.push_back({ location, type, instr->operands[1] });
+				break;
+			}
+			case IrOp::COPY: {
+				Location location = locate(instr->operands[0], instr->ivalue);
+				clobber(&location);
+				break;
+			}
+			case IrOp::CALL:
+				clobber(nullptr);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void IrValueNumbering::numberLoad(IrInstr* instr) {
+	Location location = locate(instr->operands[0], IrModule::typeSize(instr->type));
+
+	for(const KnownLoad& load : loads) {
+		bool same = load.location.address == location.address
+			|| (load.location.known && location.known && sameBase(load.location.base, location.base) && load.location.offset == location.offset);
+
+		if(same && load.type == instr->type) {
+			replacements[instr] = load.value;
+			removed++;
+			return;
+		}
+	}
+
+	loads.push_back({ location, instr->type, instr });
+}
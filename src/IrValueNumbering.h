@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "Ir.h"
+
+// Dominator based global value numbering. Walking down the dominator tree, every pure
+// instruction is looked up by its opcode, type and the value numbers of its operands
+// in a table that only holds the instructions of the dominating blocks. A match is an
+// earlier computation of the same value, which then replaces it. Operands of
+// commutative operations are sorted and a > b is numbered as b < a.
+//
+// Loads are numbered within their block. Stores and copies only forget the loads they
+// may overwrite: two distinct allocas or globals never overlap, and neither do
+// known constant offsets into the same one. Allocas whose address never escapes can't
+// be reached through other pointers or by calls either.
+class IrValueNumbering {
+private:
+	// an operand as seen by the table: a value number, a constant or a global
+	struct Operand {
+		unsigned char kind;
+		uint64_t value;
+
+		bool operator==(const Operand& other) const { return kind == other.kind && value == other.value; }
+		bool operator<(const Operand& other) const { return kind != other.kind ? kind < other.kind : value < other.value; }
+	};
+
+	struct Expression {
+		IrOp op;
+		IrType type;
+		unsigned count;
+		Operand operands[2];
+
+		bool operator==(const Expression& other) const;
+	};
+
+	struct ExpressionHash {
+		size_t operator()(const Expression& expression) const;
+	};
+
+	// where an address points: an offset into an alloca or global, if known
+	struct Location {
+		IrInstr* address;
+		IrInstr* base;		// alloca, global or whatever else the pointer came from
+		int offset;
+		bool known;			// offset is constant
+		int size;
+	};
+
+	struct KnownLoad {
+		Location location;
+		IrType type;
+		IrInstr* value;
+	};
+
+	IrFunction& function;
+	std::unordered_map<Expression, IrInstr*, ExpressionHash> table;
+	std::vector<Expression> scope;		// keys added by the open blocks, in order
+	std::unordered_map<IrInstr*, IrInstr*> replacements;
+	std::unordered_set<const IrInstr*> escaped;		// allocas
+	std::vector<KnownLoad> loads;		// of the current block
+	size_t removed = 0;
+
+	IrInstr* leader(IrInstr* value) const;
+	Operand operandOf(IrInstr* value) const;
+	bool makeExpression(IrInstr* instr, Expression& expression) const;
+
+	void findEscapes();
+	Location locate(IrInstr* address, int size) const;
+	static bool sameBase(const IrInstr* a, const IrInstr* b);
+	bool isPrivate(const IrInstr* base) const;
+	bool mayAlias(const Location& a, const Location& b) const;
+	void clobber(const Location* location);		// nullptr: all memory others can reach
+
+	void numberBlock(IrBlock* block);
+	void numberLoad(IrInstr* instr);
+
+public:
+	IrValueNumbering(IrFunction& function) : function(function) {}
+
+	// returns the number of removed instructions
+	size_t run();
+};
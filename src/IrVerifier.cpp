@@ -0,0 +1,231 @@
+#include "IrVerifier.h"
+#include <unordered_map>
+#include <algorithm>
+#include "Logger.h"
+
+// position of every instruction in its block, set up once per function
+static thread_local std::unordered_map<const IrInstr*, size_t> positions;
+static thread_local std::unordered_map<const IrBlock*, std::vector<IrBlock*>> predecessors;
+
+bool IrVerifier::verify(const IrModule& module) {
+	bool result = true;
+
+	for(auto& function : module.functions) {
+		result = verify(*function) && result;
+	}
+
+	return result;
+}
+
+bool IrVerifier::verify(const IrFunction& function) {
+	IrVerifier verifier;
+	verifier.function = &function;
+
+	positions.clear();
+	predecessors.clear();
+
+	for(auto& block : function.blocks) {
+		for(size_t i = 0; i < block->instrs.size(); i++) {
+			positions[block->instrs[i]] = i;
+		}
+		for(IrBlock* successor : block->successors()) {
+			predecessors[successor].push_back(block.get());
+		}
+	}
+
+	for(auto& block : function.blocks) {
+		if(block->function != &function) {
+			verifier.fail(block.get(), nullptr, "block belongs to another function");
+		}
+
+		if(block->terminator() == nullptr) {
+			verifier.fail(block.get(), nullptr, "block doesn't end with a terminator");
+		}
+
+		bool phis = true;
+		for(size_t i = 0; i < block->instrs.size(); i++) {
+			const IrInstr* instr = block->instrs[i];
+
+			if(instr->block != block.get()) {
+				verifier.fail(block.get(), instr, "instruction has the wrong block");
+			}
+			if(instr->isTerminator() && i + 1 != block->instrs.size()) {
+				verifier.fail(block.get(), instr, "terminator in the middle of a block");
+			}
+			if(instr->op == IrOp::PHI && !phis) {
+				verifier.fail(block.get(), instr, "phi after other instructions");
+			}
+			phis = phis && instr->op == IrOp::PHI;
+
+			verifier.verifyOperands(block.get(), instr, i);
+			verifier.verifyInstr(block.get(), instr);
+		}
+	}
+
+	return verifier.valid;
+}
+
+void IrVerifier::fail(const IrBlock* block, const IrInstr* instr, const char* problem) {
+	if(instr) {
+		Logger::getInstance().error("IR error in @%s b%u, %s: %s", function->name.c_str(), block->id, IrModule::opName(instr->op), problem);
+	}
+	else {
+		Logger::getInstance().error("IR error in @%s b%u: %s", function->name.c_str(), block->id, problem);
+	}
+	valid = false;
+}
+
+void IrVerifier::verifyOperands(const IrBlock* block, const IrInstr* instr, size_t index) {
+	for(unsigned i = 0; i < instr->count; i++) {
+		const IrInstr* operand = instr->operands[i];
+
+		if(operand == nullptr) {
+			fail(block, instr, "missing operand");
+			continue;
+		}
+
+		switch(operand->op) {
+			case IrOp::CONST:
+			case IrOp::GLOBAL:
+			case IrOp::UNDEF:
+				continue;
+			case IrOp::PARAM:
+				if(std::find(function->params.begin(), function->params.end(), operand) == function->params.end()) {
+					fail(block, instr, "parameter of another function");
+				}
+				continue;
+			default:
+				break;
+		}
+
+		if(operand->block == nullptr || operand->block->function != function || positions.count(operand) == 0) {
+			fail(block, instr, "operand isn't defined in this function");
+		}
+		else if(operand->type == IrType::VOID) {
+			fail(block, instr, "operand has no value");
+		}
+		else if(instr->op != IrOp::PHI && operand->block == block && positions[operand] >= index) {
+			fail(block, instr, "operand is used before its definition");
+		}
+	}
+}
+
+void IrVerifier::verifyInstr(const IrBlock* block, const IrInstr* instr) {
+	auto operandType = [instr](unsigned i) {
+		return (i < instr->count && instr->operands[i]) ? instr->operands[i]->type : IrType::VOID;
+	};
+	auto expect = [&](bool condition, const char* problem) {
+		if(!condition) {
+			fail(block, instr, problem);
+		}
+	};
+
+	switch(instr->op) {
+		case IrOp::CONST:
+		case IrOp::PARAM:
+		case IrOp::GLOBAL:
+		case IrOp::UNDEF:
+			fail(block, instr, "value can't be placed in a block");
+			break;
+
+		case IrOp::ALLOCA:
+			expect(instr->type == IrType::PTR && instr->count == 0 && instr->ivalue > 0, "invalid alloca");
+			expect(block == function->entry(), "alloca outside of the entry block");
+			break;
+		case IrOp::LOAD:
+			expect(instr->count == 1 && operandType(0) == IrType::PTR, "load needs a pointer");
+			expect(instr->type != IrType::VOID, "load of void");
+			break;
+		case IrOp::STORE:
+			expect(instr->count == 2 && operandType(0) == IrType::PTR, "store needs a pointer");
+			expect(operandType(1) != IrType::VOID, "store of void");
+			break;
+		case IrOp::COPY:
+			expect(instr->count == 2 && operandType(0) == IrType::PTR && operandType(1) == IrType::PTR, "copy needs two pointers");
+			expect(instr->ivalue > 0, "copy without size");
+			break;
+		case IrOp::ADDPTR:
+			expect(instr->type == IrType::PTR && instr->count == 2 && operandType(0) == IrType::PTR && operandType(1) == IrType::INT, "addptr needs a pointer and an int");
+			break;
+
+		case IrOp::ADD:
+		case IrOp::SUB:
+		case IrOp::MUL:
+		case IrOp::DIV:
+		case IrOp::MOD:
+			expect(instr->count == 2 && operandType(0) == instr->type && operandType(1) == instr->type, "operand types don't match");
+			expect(instr->type == IrType::INT || instr->type == IrType::CHAR || instr->type == IrType::FLOAT, "arithmetic on an invalid type");
+			break;
+		case IrOp::AND:
+		case IrOp::OR:
+		case IrOp::XOR:
+			expect(instr->count == 2 && operandType(0) == instr->type && operandType(1) == instr->type, "operand types don't match");
+			expect(instr->type == IrType::INT || instr->type == IrType::CHAR || instr->type == IrType::BOOL, "bitwise operation on an invalid type");
+			break;
+		case IrOp::NEG:
+			expect(instr->count == 1 && operandType(0) == instr->type, "operand type doesn't match");
+			expect(instr->type == IrType::INT || instr->type == IrType::CHAR || instr->type == IrType::FLOAT, "negation of an invalid type");
+			break;
+		case IrOp::BNOT:
+			expect(instr->count == 1 && operandType(0) == instr->type && (instr->type == IrType::INT || instr->type == IrType::CHAR), "~ needs an int");
+			break;
+		case IrOp::NOT:
+			expect(instr->count == 1 && operandType(0) == IrType::BOOL && instr->type == IrType::BOOL, "! needs a bool");
+			break;
+
+		case IrOp::EQ:
+		case IrOp::NE:
+		case IrOp::LT:
+		case IrOp::LE:
+		case IrOp::GT:
+		case IrOp::GE:
+			expect(instr->type == IrType::BOOL, "comparison must be bool");
+			expect(instr->count == 2 && operandType(0) == operandType(1) && operandType(0) != IrType::VOID, "compared types don't match");
+			break;
+
+		case IrOp::CAST:
+			expect(instr->count == 1 && operandType(0) != IrType::VOID && instr->type != IrType::VOID, "invalid cast");
+			break;
+		case IrOp::CALL: {
+			if(instr->callee == nullptr) {
+				fail(block, instr, "call without callee");
+				break;
+			}
+
+			const std::vector<IrInstr*>& params = instr->callee->params;
+			expect(instr->type == instr->callee->returnType, "call type doesn't match the callee");
+			expect(instr->count == params.size(), "wrong number of arguments");
+
+			for(unsigned i = 0; i < instr->count && i < params.size(); i++) {
+				expect(operandType(i) == params[i]->type, "argument type doesn't match");
+			}
+			break;
+		}
+		case IrOp::PHI: {
+			const std::vector<IrBlock*>& preds = predecessors[block];
+			expect(instr->count == preds.size(), "phi doesn't have one value per predecessor");
+
+			for(unsigned i = 0; i < instr->count; i++) {
+				expect(operandType(i) == instr->type, "phi operand type doesn't match");
+				expect(std::find(preds.begin(), preds.end(), instr->targets[i]) != preds.end(), "phi value from a block that isn't a predecessor");
+			}
+			break;
+		}
+
+		case IrOp::BR:
+			expect(instr->count == 0 && instr->targets[0] && instr->targets[0]->function == function, "invalid branch target");
+			break;
+		case IrOp::CONDBR:
+			expect(instr->count == 1 && operandType(0) == IrType::BOOL, "condition must be bool");
+			expect(instr->targets[0] && instr->targets[1] && instr->targets[0]->function == function && instr->targets[1]->function == function, "invalid branch target");
+			break;
+		case IrOp::RET:
+			if(function->returnType == IrType::VOID) {
+				expect(instr->count == 0, "void function returns a value");
+			}
+			else {
+				expect(instr->count == 1 && operandType(0) == function->returnType, "return type doesn't match");
+			}
+			break;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include "Ir.h"
+
+// Checks the structural rules of the IR: every block ends in its only terminator, phis
+// come first and match the predecessors, operands have the types their instruction
+// expects and are defined in the same function. Problems are internal errors of the
+// compiler, so they are reported through the Logger, not as diagnostics.
+class IrVerifier {
+private:
+	const IrFunction* function;
+	bool valid = true;
+
+	void fail(const IrBlock* block, const IrInstr* instr, const char* problem);
+	void verifyInstr(const IrBlock* block, const IrInstr* instr);
+	void verifyOperands(const IrBlock* block, const IrInstr* instr, size_t index);
+
+public:
+	static bool verify(const IrModule& module);
+	static bool verify(const IrFunction& function);
+};
@@ -0,0 +1,138 @@
+#include "Layout.h"
+#include "Diagnostics.h"
+#include "ConstFolder.h"
+
+AstType* Layout::resolve(AstType* type) {
+	while(type->type == AstType::NAMED) {
+		AstDecl* decl = ((AstNamedType*)type)->declaration;
+		AstTypeDecl* typeDecl = dynamic_cast<AstTypeDecl*>(decl);
+
+		if(typeDecl == nullptr) {
+			break;
+		}
+		type = typeDecl->type;
+	}
+
+	return type;
+}
+
+static int arrayLength(AstArrayType* arrayType) {
+	if(arrayType->size >= 0) {
+		return arrayType->size;
+	}
+
+	// struct fields may be laid out before their types are resolved
+	ConstValue value;
+	if(!ConstFolder::evaluate(arrayType->expr, value) || value.type != AstType::INT || value.ivalue < 0) {
+		return -1;
+	}
+	return value.ivalue;
+}
+
+AstStructDecl* Layout::structOf(AstType* type) {
+	type = resolve(type);
+
+	if(type->type != AstType::NAMED) {
+		return nullptr;
+	}
+	return dynamic_cast<AstStructDecl*>(((AstNamedType*)type)->declaration);
+}
+
+int Layout::sizeOf(AstType* type) {
+	type = resolve(type);
+
+	switch(type->type) {
+		case AstType::CHAR:
+		case AstType::BOOL:
+			return 1;
+		case AstType::INT:
+		case AstType::FLOAT:
+			return 4;
+		case AstType::PTR:
+			return PTR_SIZE;
+		case AstType::ARRAY: {
+			int length = arrayLength((AstArrayType*)type);
+			int size = sizeOf(((AstArrayType*)type)->arrayType);
+			return (length < 0 || size < 0) ? -1 : length * size;
+		}
+		case AstType::NAMED: {
+			AstStructDecl* structDecl = structOf(type);
+			if(structDecl == nullptr || !layoutStruct(structDecl)) {
+				return -1;
+			}
+			return structDecl->size;
+		}
+		default:
+			return -1;
+	}
+}
+
+int Layout::alignOf(AstType* type) {
+	type = resolve(type);
+
+	switch(type->type) {
+		case AstType::ARRAY:
+			return alignOf(((AstArrayType*)type)->arrayType);
+		case AstType::NAMED: {
+			AstStructDecl* structDecl = structOf(type);
+			if(structDecl == nullptr || !layoutStruct(structDecl)) {
+				return -1;
+			}
+			return structDecl->align;
+		}
+		default:
+			return sizeOf(type);
+	}
+}
+
+bool Layout::layoutStruct(AstStructDecl* structDecl) {
+	if(structDecl->size >= 0) {
+		return true;
+	}
+	if(structDecl->layoutFailed) {
+		return false;
+	}
+
+	if(structDecl->layingOut) {
+		Diagnostics::error("T031", structDecl->loc, "Struct %s contains itself", structDecl->name);
+		return false;
+	}
+	structDecl->layingOut = true;
+
+	int offset = 0;
+	int align = 1;
+	std::vector<int> offsets;
+	std::unordered_map<std::string, int> fieldIndex;
+
+	for(int i = 0; i < structDecl->fields.size(); i++) {
+		AstVarDecl& field = structDecl->fields[i];
+		int fieldSize = sizeOf(field.type);
+
+		if(fieldSize < 0) {
+			// nested structs report their own errors
+			if(structOf(field.type) == nullptr) {
+				Diagnostics::error("T032", field.loc, "Field %s of struct %s has no known size", field.name, structDecl->name);
+			}
+			structDecl->layingOut = false;
+			structDecl->layoutFailed = true;
+			return false;
+		}
+
+		int fieldAlign = alignOf(field.type);
+
+		offset = (offset + fieldAlign - 1) / fieldAlign * fieldAlign;
+		offsets.push_back(offset);
+		fieldIndex[field.name] = i;
+
+		offset += fieldSize;
+		align = std::max(align, fieldAlign);
+	}
+
+	structDecl->offsets = offsets;
+	structDecl->fieldIndex = fieldIndex;
+	structDecl->align = align;
+	structDecl->size = (offset + align - 1) / align * align;
+	structDecl->layingOut = false;
+
+	return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "Ast.h"
+
+// Sizes, alignments and field offsets of types. All functions return -1 (or nullptr)
+// for types that have no layout, e.g. void or arrays of unknown size.
+//
+// Every struct is laid out, or marked as failed, by the signature pass on one thread.
+// The parallel body pass then only reads the layouts, so it may call these freely.
+class Layout {
+public:
+	static const int PTR_SIZE = 8;
+
+	static int sizeOf(AstType* type);
+	static int alignOf(AstType* type);
+
+	static bool layoutStruct(AstStructDecl* structDecl);
+
+	// follows typedefs to the type they name
+	static AstType* resolve(AstType* type);
+
+	// follows typedefs, returns nullptr if type isn't a struct
+	static AstStructDecl* structOf(AstType* type);
+};
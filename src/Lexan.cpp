@@ -1,5 +1,6 @@
 #include "Lexan.h"
 #include "Logger.h"
+#include "Diagnostics.h"
 #include <fstream>
 #include <ctype.h>
 
@@ -9,7 +10,6 @@ Lexan::Lexan() {
 }
 
 bool Lexan::parse(const std::string& file) {
-	tokens.clear();
 	std::ifstream input(file);
 	
 	if (!input.is_open()) {
@@ -17,16 +17,20 @@ bool Lexan::parse(const std::string& file) {
 		return false;
 	}
 
+	return parse(input);
+}
+
+bool Lexan::parse(std::istream& input) {
+	tokens.clear();
+
+	// a bad line only ends that line, so one run reports every bad line
+	bool result = true;
 	std::string line;
 	for(int i = 0; std::getline(input, line); i++) {
-		if(!parseLine(line, i)) {
-			return false;
-		}
+		result = parseLine(line, i) && result;
 	}
 
-	input.close();
-
-	return true;
+	return result;
 }
 
 bool Lexan::parseLine(std::string& line, int i) {
@@ -182,7 +186,7 @@ bool Lexan::parseLine(std::string& line, int i) {
 					j += 2;
 				}
 				else {
-					Logger::getInstance().error("Lexan: Invalid single quote on line %d[%d]\n", (i+1), j);
+					Diagnostics::error("L001", Location(i + 1, j, j), "Invalid single quote");
 					return false;
 				}
 				break;
@@ -200,15 +204,14 @@ bool Lexan::parseLine(std::string& line, int i) {
 							continue;
 						}
 						else if(line[j] == '.' && dot) { 
-							printTokens();
-							Logger::getInstance().error("Lexan: Invalid number on line %d[%d]\n", (i+1), j);
+							Diagnostics::error("L002", Location(i + 1, start, j), "Invalid number");
 							return false; 
 						}
 						if(!isdigit(line[j])) break;
 					}
 
 					if(isalpha(line[j])) {
-						Logger::getInstance().error("Lexan: Invalid number on line %d[%d]\n", (i+1), start);
+						Diagnostics::error("L002", Location(i + 1, start, j), "Invalid number");
 						return false;
 					}
 					j--;
@@ -265,7 +268,7 @@ bool Lexan::parseLine(std::string& line, int i) {
 					}
 				}
 				else {
-					Logger::getInstance().error("Lexan: Invalid character on line %d[%d]\n", (i+1), j);
+					Diagnostics::error("L003", Location(i + 1, j, j), "Invalid character '%s'", std::string(1, line[j]));
 					return false;
 				}
 				break;
@@ -275,13 +278,16 @@ bool Lexan::parseLine(std::string& line, int i) {
 	return true;
 }
 
-void Lexan::printTokens() {
+void Lexan::printTokens(std::ostream& out) {
+	if(tokens.empty())
+		return;
+
 	int l = tokens[0].getLine();
 	for(auto& t : tokens) {
 		if(l != t.getLine())
-			std::cout << std::endl;
-		std::cout << t << " ";
+			out << std::endl;
+		out << t << " ";
 		l = t.getLine();
 	}
-	std::cout << std::endl;
+	out << std::endl;
 }
@@ -11,9 +11,10 @@ public:
 	Lexan();
 
 	bool parse(const std::string& file);
+	bool parse(std::istream& input);		// source already read into memory
 	bool parseLine(std::string& line, int i);
 
-	void printTokens();
+	void printTokens(std::ostream& out);
 
 	const std::vector<Token>& getTokens() const { return tokens; }
 };
@@ -0,0 +1,39 @@
+#include "LogSink.h"
+
+void StdoutSink::write(const std::string& text) {
+	fwrite(text.data(), 1, text.size(), stdout);
+}
+
+void StdoutSink::flush() {
+	fflush(stdout);
+}
+
+FileSink::FileSink(const std::string& path) : file(fopen(path.c_str(), "w")) {}
+
+FileSink::~FileSink() {
+	if(file) {
+		fclose(file);
+	}
+}
+
+void FileSink::write(const std::string& text) {
+	if(file) {
+		fwrite(text.data(), 1, text.size(), file);
+	}
+}
+
+void FileSink::flush() {
+	if(file) {
+		fflush(file);
+	}
+}
+
+void MemorySink::write(const std::string& text) {
+	std::lock_guard<std::mutex> guard(lock);
+	contents += text;
+}
+
+std::string MemorySink::getContents() {
+	std::lock_guard<std::mutex> guard(lock);
+	return contents;
+}
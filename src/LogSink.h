@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <stdio.h>
+
+// Destination of the Logger's background writer. Only the writer thread calls write()
+// and flush(), one at a time.
+class LogSink {
+public:
+	virtual ~LogSink() {}
+
+	virtual void write(const std::string& text) = 0;
+	virtual void flush() {}
+};
+
+class StdoutSink : public LogSink {
+public:
+	void write(const std::string& text) override;
+	void flush() override;
+};
+
+class FileSink : public LogSink {
+private:
+	FILE* file;
+
+public:
+	FileSink(const std::string& path);
+	~FileSink();
+
+	bool isOpen() const { return file != nullptr; }
+
+	void write(const std::string& text) override;
+	void flush() override;
+};
+
+// Keeps everything in memory, e.g. to compare the output in tests
+class MemorySink : public LogSink {
+private:
+	std::mutex lock;
+	std::string contents;
+
+public:
+	void write(const std::string& text) override;
+
+	std::string getContents();
+};
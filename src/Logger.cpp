@@ -1,28 +1,199 @@
 #include "Logger.h"
-#include <iostream>
 #include "Font.h"
+#include <atomic>
+#include <unordered_map>
+#include <cstring>
+
+thread_local std::string* Logger::buffer = nullptr;
+
+static std::atomic<bool> alive;
+
+namespace {
+	// leftovers of exiting threads still reach the sink
+	struct LocalBuffer {
+		std::string text;
+
+		~LocalBuffer() {
+			if(!text.empty() && alive) {
+				Logger::getInstance().submit();
+			}
+		}
+	};
+}
+
+static thread_local LocalBuffer local;
+
+Logger::Logger() : sink(new StdoutSink()) {
+	writer = std::thread(&Logger::writeQueued, this);
+	alive = true;
+}
+
+Logger::~Logger() {
+	flush();
+	alive = false;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+std::string& Logger::localBuffer() {
+	return local.text;
+}
+
+void Logger::writeQueued() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	while(true) {
+		wake.wait(guard, [this] { return stopping || !queue.empty(); });
+		if(queue.empty()) {
+			return;
+		}
+
+		std::deque<std::string> batch;
+		batch.swap(queue);
+		writing = true;
+
+		// terminal I/O happens here, outside the lock, while the compiler keeps going
+		guard.unlock();
+		for(const std::string& text : batch) {
+			sink->write(text);
+		}
+		sink->flush();
+		guard.lock();
+
+		writing = false;
+		drained.notify_all();
+	}
+}
+
+void Logger::submit() {
+	std::string& text = localBuffer();
+	if(text.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		queue.emplace_back(std::move(text));
+	}
+	text.clear();
+	wake.notify_one();
+}
+
+void Logger::flush() {
+	submit();
+
+	std::unique_lock<std::mutex> guard(lock);
+	drained.wait(guard, [this] { return queue.empty() && !writing; });
+}
+
+void Logger::setSink(std::unique_ptr<LogSink> sink) {
+	flush();
+
+	std::lock_guard<std::mutex> guard(lock);
+	this->sink = std::move(sink);
+}
+
+std::string* Logger::capture(std::string* buffer) {
+	std::string* previous = Logger::buffer;
+	Logger::buffer = buffer;
+	return previous;
+}
+
+void Logger::append(const std::string& text) {
+	std::string& target = buffer ? *buffer : localBuffer();
+	target += text;
+
+	if(buffer == nullptr && target.size() >= BUFFER_LIMIT) {
+		submit();
+	}
+}
+
+void Logger::write(const std::string& text) {
+	append(text);
+}
 
 void Logger::debug(const std::string& msg) {
 	if(!debugEnabled) return;
 
-	std::cout << msg << std::endl;
+	print("", "%s", "\n", msg.c_str());
 }
 
 void Logger::log(const std::string& msg) {
-	formatted(msg, false, nullptr);
-	// std::cout << Font::italic << msg << Font::reset << std::endl;
+	if(quiet) return;
+
+	const FormatTemplate& resolved = compileFormat(msg);
+	append(Font::enabled ? resolved.colored : resolved.plain);
 }
 
 void Logger::error(const std::string& msg) {
-	std::cout << Font::fred << msg << Font::reset << std::endl;
+	static const std::string suffix = Font::reset + "\n";
+
+	if(Font::enabled) {
+		print(Font::fred.c_str(), "%s", suffix.c_str(), msg.c_str());
+	}
+	else {
+		print("", "%s", "\n", msg.c_str());
+	}
 }
 
-void Logger::replaceAll(std::string& str, std::string find, std::string replace) {
-	for(size_t index = 0; true; index += replace.size()) {
-		index = str.find(find, index);
-		if (index == std::string::npos) 
-			break;
+const Logger::FormatTemplate& Logger::compileFormat(const std::string& format) {
+	struct Marker {
+		const char* name;
+		const std::string& code;
+	};
 
-		str.replace(index, find.size(), replace);
+	// longer names first, so #red isn't read as #r followed by "ed"
+	static const Marker markers[] = {
+		{ "red", Font::fred },
+		{ "grn", Font::fgreen },
+		{ "blu", Font::fblue },
+		{ "i", Font::italic },
+		{ "b", Font::bold },
+		{ "u", Font::underline },
+		{ "r", Font::reset }
+	};
+	static const size_t MAX_TEMPLATES = 1024;
+
+	// per thread, so lookups need no lock
+	static thread_local std::unordered_map<std::string, FormatTemplate> templates;
+
+	auto it = templates.find(format);
+	if(it != templates.end()) {
+		return it->second;
 	}
+
+	FormatTemplate resolved;
+	for(size_t i = 0; i < format.size(); i++) {
+		const Marker* match = nullptr;
+
+		if(format[i] == '#') {
+			for(const Marker& marker : markers) {
+				if(format.compare(i + 1, strlen(marker.name), marker.name) == 0) {
+					match = &marker;
+					break;
+				}
+			}
+		}
+
+		if(match) {
+			resolved.colored += match->code;
+			i += strlen(match->name);
+		}
+		else {
+			resolved.colored += format[i];
+			resolved.plain += format[i];
+		}
+	}
+
+	// formats are nearly always literals, this only guards against runaway dynamic ones
+	if(templates.size() >= MAX_TEMPLATES) {
+		templates.clear();
+	}
+
+	return templates.emplace(format, std::move(resolved)).first->second;
 }
@@ -1,60 +1,135 @@
 #pragma once
 #include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <stdio.h>
 #include "Font.h"
+#include "LogSink.h"
 
+// Messages are formatted into a buffer of the logging thread and handed to a single
+// background writer once the buffer fills up or on submit()/flush(). Output of one
+// thread keeps its order, submit() orders it against the other threads.
 class Logger {
 private:
+	static const size_t BUFFER_LIMIT = 64 << 10;
+
+	// format with its #markers resolved, e.g. "#i#grnPhase#r" -> italic green "Phase" reset
+	struct FormatTemplate {
+		std::string colored;
+		std::string plain;
+	};
+
 	bool debugEnabled = false;
+	bool quiet = false;			// drop everything but errors
+	static thread_local std::string* buffer;
+
+	std::unique_ptr<LogSink> sink;
+	std::deque<std::string> queue;	// submitted, not yet written
+	bool writing = false;
+	bool stopping = false;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable drained;
+	std::thread writer;
+
+	Logger();
+	~Logger();
 
-	Logger() {}
+	static std::string& localBuffer();
+	static const FormatTemplate& compileFormat(const std::string& format);
+	void writeQueued();
+	void append(const std::string& text);
 
-	void replaceAll(std::string& str, std::string find, std::string replace);
+	template<typename... Args>
+	void print(const char* prefix, const std::string& format, const char* suffix, Args... args) {
+		std::string& target = buffer ? *buffer : localBuffer();
+
+		target.append(prefix);
+		int size = snprintf(nullptr, 0, format.c_str(), args...);
+		size_t offset = target.size();
+		target.resize(offset + size + 1);
+		snprintf(&target[offset], size + 1, format.c_str(), args...);
+		target.resize(offset + size);
+		target.append(suffix);
+
+		if(buffer == nullptr && target.size() >= BUFFER_LIMIT) {
+			submit();
+		}
+	}
 public:
+#ifdef NDEBUG
+	static constexpr bool DEBUG_LOGS = false;	// LOG_DEBUG compiles to nothing
+#else
+	static constexpr bool DEBUG_LOGS = true;
+#endif
+
 	static Logger& getInstance() {
 		static Logger instance;
 		return instance;
 	}
 
+	// redirects this thread's output into buffer (nullptr prints again), returns the previous buffer
+	std::string* capture(std::string* buffer);
+
+	void submit();		// hands this thread's output to the writer
+	void flush();		// submit() and wait until everything submitted reached the sink
+	void setSink(std::unique_ptr<LogSink> sink);
+
+	void setQuiet(bool quiet) { this->quiet = quiet; }
+	void setDebug(bool enabled) { debugEnabled = enabled; }
+	bool isDebugEnabled() const { return debugEnabled; }
+
+	void write(const std::string& text);	// raw, e.g. replaying captured output
 	void debug(const std::string& msg);
 	void log(const std::string& msg);
 	void error(const std::string& msg);
 
+	// prefer LOG_DEBUG, which skips evaluating the arguments
 	template<typename... Args>
-	void debug(std::string format, Args... args) {
+	void debug(const std::string& format, Args... args) {
 		if (!debugEnabled) return;
-		format.append("\n");
 
-		printf(format.c_str(), args...);
+		print("", format, "\n", args...);
 	}
 
 	template<typename... Args>
-	void log(std::string format, Args... args) {
-		// format.insert(0, Font::italic);
-		// format.append(Font::reset);
-		format.append("\n");
-		printf(format.c_str(), args...);
+	void log(const std::string& format, Args... args) {
+		if (quiet) return;
+
+		print("", format, "\n", args...);
 	}
 
 	template<typename... Args>
-	void error(std::string format, Args... args) {
-		format.insert(0, Font::fred);
-		format.append(Font::reset);
-		format.append("\n");
+	void error(const std::string& format, Args... args) {
+		static const std::string suffix = Font::reset + "\n";
 
-		printf(format.c_str(), args...);
+		if(Font::enabled) {
+			print(Font::fred.c_str(), format, suffix.c_str(), args...);
+		}
+		else {
+			print("", format, "\n", args...);
+		}
 	}
 
+	// #i, #b, #u, #r, #red, #grn and #blu become font codes, or nothing if replaceNull
 	template<typename... Args>
-	void formatted(std::string format, bool replaceNull, Args... args) {
-		replaceAll(format, "#i", replaceNull ? "" : Font::italic);
-		replaceAll(format, "#b", replaceNull ? "" : Font::bold);
-		replaceAll(format, "#u", replaceNull ? "" : Font::underline);
-		replaceAll(format, "#r", replaceNull ? "" : Font::reset);
-		replaceAll(format, "#red", replaceNull ? "" : Font::fred);
-		replaceAll(format, "#grn", replaceNull ? "" : Font::fgreen);
-		replaceAll(format, "#blu", replaceNull ? "" : Font::fblue);
-
-		printf(format.c_str(), args...);
+	void formatted(const std::string& format, bool replaceNull, Args... args) {
+		const FormatTemplate& resolved = compileFormat(format);
+
+		print("", (replaceNull || !Font::enabled) ? resolved.plain : resolved.colored, "", args...);
 	}
+
 };
+
+// Debug output for hot paths. The arguments are only evaluated when debug output is
+// enabled at runtime, and release builds (NDEBUG) drop the whole statement.
+#define LOG_DEBUG(...) do { \
+	if constexpr(Logger::DEBUG_LOGS) { \
+		if(Logger::getInstance().isDebugEnabled()) { \
+			Logger::getInstance().debug(__VA_ARGS__); \
+		} \
+	} \
+} while(0)
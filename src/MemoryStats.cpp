@@ -0,0 +1,211 @@
+#include "MemoryStats.h"
+#include "Logger.h"
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <malloc.h>
+#include <sys/resource.h>
+
+namespace {
+	struct AtomicCounters {
+		std::atomic<size_t> allocations;
+		std::atomic<size_t> bytes;
+		std::atomic<size_t> frees;
+		std::atomic<size_t> freedBytes;
+	};
+}
+
+// all zero initialized before any constructor can allocate
+static std::atomic<bool> enabled;
+static AtomicCounters counters[MemoryStats::PHASES];
+// signed, blocks allocated before enable() may be freed later
+static std::atomic<long long> live;
+static std::atomic<long long> peak;
+static std::atomic<long long> baseline;		// live at reset()
+
+thread_local MemoryStats::Phase MemoryStats::current = MemoryStats::OTHER;
+
+static const char* phaseNames[MemoryStats::PHASES] = {
+	"other",
+	"lexical analysis",
+	"syntax analysis",
+	"name resolution",
+	"type resolution",
+	"ir lowering",
+	"ir optimization"
+};
+
+static void recordAllocation(void* ptr) {
+	size_t size = malloc_usable_size(ptr);
+	AtomicCounters& counter = counters[MemoryStats::getPhase()];
+
+	counter.allocations.fetch_add(1, std::memory_order_relaxed);
+	counter.bytes.fetch_add(size, std::memory_order_relaxed);
+
+	long long now = live.fetch_add(size, std::memory_order_relaxed) + size;
+	long long high = peak.load(std::memory_order_relaxed);
+	while(now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed));
+}
+
+static void recordFree(void* ptr) {
+	size_t size = malloc_usable_size(ptr);
+	AtomicCounters& counter = counters[MemoryStats::getPhase()];
+
+	counter.frees.fetch_add(1, std::memory_order_relaxed);
+	counter.freedBytes.fetch_add(size, std::memory_order_relaxed);
+	live.fetch_sub(size, std::memory_order_relaxed);
+}
+
+static void* allocate(size_t size) {
+	void* ptr = malloc(size ? size : 1);
+	if(ptr == nullptr) {
+		return nullptr;
+	}
+
+	if(enabled.load(std::memory_order_relaxed)) {
+		recordAllocation(ptr);
+	}
+	return ptr;
+}
+
+static void deallocate(void* ptr) {
+	if(ptr == nullptr) {
+		return;
+	}
+
+	if(enabled.load(std::memory_order_relaxed)) {
+		recordFree(ptr);
+	}
+	free(ptr);
+}
+
+void* operator new(size_t size) {
+	void* ptr = allocate(size);
+	if(ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+
+
+
+void MemoryStats::enable() {
+	enabled = true;
+}
+
+bool MemoryStats::isEnabled() {
+	return enabled;
+}
+
+void MemoryStats::reset() {
+	for(AtomicCounters& counter : counters) {
+		counter.allocations = 0;
+		counter.bytes = 0;
+		counter.frees = 0;
+		counter.freedBytes = 0;
+	}
+
+	baseline = live.load();
+	peak = baseline.load();
+
+	// restarts the VmHWM high water mark, kernels without it keep the process peak
+	FILE* file = fopen("/proc/self/clear_refs", "w");
+	if(file) {
+		fputs("5", file);
+		fclose(file);
+	}
+}
+
+MemoryStats::Phase MemoryStats::setPhase(Phase phase) {
+	Phase previous = current;
+	current = phase;
+	return previous;
+}
+
+MemoryStats::Counters MemoryStats::getCounters(Phase phase) {
+	AtomicCounters& counter = counters[phase];
+	return { counter.allocations.load(), counter.bytes.load(), counter.frees.load(), counter.freedBytes.load() };
+}
+
+size_t MemoryStats::getPeakHeap() {
+	return std::max(peak - baseline, 0LL);
+}
+
+size_t MemoryStats::getPeakRss() {
+	FILE* file = fopen("/proc/self/status", "r");
+	if(file) {
+		char line[256];
+		size_t kilobytes = 0;
+		bool found = false;
+
+		while(!found && fgets(line, sizeof(line), file)) {
+			found = sscanf(line, "VmHWM: %zu kB", &kilobytes) == 1;
+		}
+		fclose(file);
+
+		if(found) {
+			return kilobytes * 1024;
+		}
+	}
+
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return (size_t)usage.ru_maxrss * 1024;	// kilobytes on Linux
+}
+
+void MemoryStats::print(bool json) {
+	Logger& logger = Logger::getInstance();
+
+	if(json) {
+		std::string text = "{\"phases\": [";
+		for(int i = 0; i < PHASES; i++) {
+			Counters counter = getCounters((Phase)i);
+
+			text += (i == 0) ? "\n" : ",\n";
+			text += "  {\"name\": \"" + std::string(phaseNames[i]) + "\"";
+			text += ", \"allocations\": " + std::to_string(counter.allocations);
+			text += ", \"bytes\": " + std::to_string(counter.bytes);
+			text += ", \"frees\": " + std::to_string(counter.frees);
+			text += ", \"freed_bytes\": " + std::to_string(counter.freedBytes) + "}";
+		}
+		text += "\n], \"peak_heap\": " + std::to_string(getPeakHeap());
+		text += ", \"peak_rss\": " + std::to_string(getPeakRss()) + "}\n";
+
+		logger.write(text);
+		return;
+	}
+
+	logger.log("#i#grnMemory report#r\n");
+	logger.log("%-24s %12s %14s %12s %14s", "phase", "allocations", "bytes", "frees", "freed bytes");
+
+	for(int i = 0; i < PHASES; i++) {
+		Counters counter = getCounters((Phase)i);
+		logger.log("%-24s %12zu %14zu %12zu %14zu", phaseNames[i], counter.allocations, counter.bytes, counter.frees, counter.freedBytes);
+	}
+
+	logger.log("%-24s %12.1f KiB", "peak heap", getPeakHeap() / 1024.0);
+	logger.log("%-24s %12.1f KiB", "peak rss", getPeakRss() / 1024.0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+
+// Heap accounting behind the global operator new/delete. Every allocation is charged
+// to the phase tagged on the allocating thread (see MemoryScope). While disabled the
+// operators only test a flag before calling malloc/free. Counters and peaks cover the
+// time since the last reset(), so a resident server reports each request on its own.
+class MemoryStats {
+public:
+	enum Phase {
+		OTHER,
+		LEX,
+		PARSE,
+		NAMES,
+		TYPES,
+		IR,
+		OPT,
+		PHASES
+	};
+
+	struct Counters {
+		size_t allocations;
+		size_t bytes;
+		size_t frees;
+		size_t freedBytes;
+	};
+
+private:
+	static thread_local Phase current;
+
+public:
+	static void enable();
+	static bool isEnabled();
+	static void reset();				// starts a new measured run
+
+	static Phase getPhase() { return current; }
+	static Phase setPhase(Phase phase);	// returns the previous phase
+
+	static Counters getCounters(Phase phase);
+	static size_t getPeakHeap();		// most bytes live at once, above those live at reset()
+	static size_t getPeakRss();			// bytes, since reset() where the kernel allows it
+
+	static void print(bool json);
+};
+
+// Tags allocations of the current thread with a phase for the enclosing scope
+class MemoryScope {
+private:
+	MemoryStats::Phase previous;
+
+public:
+	MemoryScope(MemoryStats::Phase phase) : previous(MemoryStats::setPhase(phase)) {}
+	~MemoryScope() { MemoryStats::setPhase(previous); }
+
+	MemoryScope(const MemoryScope&) = delete;
+	MemoryScope& operator=(const MemoryScope&) = delete;
+};
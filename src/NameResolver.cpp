@@ -1,34 +1,33 @@
 #include "NameResolver.h"
 #include "Ast.h"
 #include "Logger.h"
+#include "Diagnostics.h"
 
-void NameResolver::clearSymbolDepth() {
-	for(auto it = symbolTable.rbegin(); it != symbolTable.rend(); it++) {
-		if(it->depth > depth) {
-			symbolTable.erase((it + 1).base());
-		}
-	}
+bool NameResolver::isNameValid(const std::string& name, bool type) {
+	return !symbolTable.isDeclared(name, type);
 }
 
-bool NameResolver::isNameValid(const std::string& name, bool type) {
-	for (auto& symb : symbolTable) {
-		if (symb.name == name && symb.depth == depth && symb.isType == type) {
-			return false;
-		}
+AstDecl* NameResolver::findDecl(const std::string& name, bool type) {
+	LOG_DEBUG("Looking for %s[%d]", name.c_str(), type);
+	AstDecl* decl = symbolTable.find(name, type);
+
+	if(decl == nullptr && globals != nullptr) {
+		decl = globals->find(name, type);
 	}
-	return true;
+	return decl;
 }
 
-AstDecl* NameResolver::findDecl(const std::string& name, bool type) {
-	Logger::getInstance().debug("Looking for %s[%d]", name.c_str(), type);
-	for(auto it = symbolTable.rbegin(); it != symbolTable.rend(); it++) {
-		Logger::getInstance().debug(" - at %s[%d, %d]", it->name.c_str(), it->depth, it->isType);
-		if(it->name == name && it->isType == type) {
-			return it->decl;
-		}
+bool NameResolver::resolveStmts(std::vector<AstStmt*>& stmts) {
+	// keeps going after an error to report the rest too, a failed declaration is
+	// still declared so its uses don't cause follow-up errors
+	bool result = true;
+
+	for(auto& stmt : stmts) {
+		result = stmt->accept(this, Phase::BODY) && result;
+		result = stmt->accept(this, Phase::HEAD) && result;
 	}
 
-	return nullptr;
+	return result;
 }
 
 
@@ -36,10 +35,10 @@ AstDecl* NameResolver::findDecl(const std::string& name, bool type) {
 bool NameResolver::visit(AstVarDecl* varDecl, Phase phase) {
 	if(phase == Phase::HEAD) {
 		if(!isNameValid(varDecl->name)) {
-			Logger::getInstance().error("Name error: Variable %s%s redeclared!", varDecl->name.c_str(), varDecl->loc.toString().c_str());
+			Diagnostics::error("N001", varDecl->loc, "Variable %s redeclared", varDecl->name);
 			return false;
 		}
-		symbolTable.push_back({ varDecl->name, false, depth , varDecl});
+		symbolTable.insert(varDecl->name, false, varDecl);
 	}
 	else {
 		if(!varDecl->type->accept(this, phase)) {
@@ -67,33 +66,31 @@ bool NameResolver::visit(AstParDecl* parDecl, Phase phase) {
 bool NameResolver::visit(AstFunDecl* funDecl, Phase phase) {
 	if(phase == Phase::HEAD) {
 		if(!isNameValid(funDecl->name)) {
-			Logger::getInstance().error("Name error: Function %s%s redeclared!", funDecl->name.c_str(), funDecl->loc.toString().c_str());
+			Diagnostics::error("N002", funDecl->loc, "Function %s redeclared", funDecl->name);
 			return false;
 		}
-		symbolTable.push_back({ funDecl->name, false, depth , funDecl});
+		symbolTable.insert(funDecl->name, false, funDecl);
 	}
 	else {
 		if(!funDecl->type->accept(this, phase)) {
 			return false;
 		}
 		
-		depth++;
+		// params and the outermost body statements share one scope
+		symbolTable.enterScope();
+		bool result = true;
 
-		if(funDecl->params && !funDecl->params->accept(this, Phase::HEAD)) {
-			return false;
+		if(funDecl->params) {
+			result = funDecl->params->accept(this, Phase::HEAD) && result;
+			result = funDecl->params->accept(this, Phase::BODY) && result;
 		}
 
-		if(funDecl->params && !funDecl->params->accept(this, Phase::BODY)) {
-			return false;
+		if(funDecl->body) {
+			result = resolveStmts(((AstCompStmt*)funDecl->body)->stmts) && result;
 		}
 
-		depth--;
-
-		if(funDecl->body && !funDecl->body->accept(this, phase)) {
-			return false;
-		}
-
-		// no need to cleanup the symbol table because comp stmt clears it
+		symbolTable.exitScope();
+		return result;
 	}
 
 	return true;
@@ -102,10 +99,10 @@ bool NameResolver::visit(AstFunDecl* funDecl, Phase phase) {
 bool NameResolver::visit(AstTypeDecl* typeDecl, Phase phase) {
 	if(phase == Phase::HEAD) {
 		if(!isNameValid(typeDecl->name, true)) {
-			Logger::getInstance().error("Name error: Type %s%s redeclared!", typeDecl->name.c_str(), typeDecl->loc.toString().c_str());
+			Diagnostics::error("N003", typeDecl->loc, "Type %s redeclared", typeDecl->name);
 			return false;
 		}
-		symbolTable.push_back({ typeDecl->name, true, depth , typeDecl});
+		symbolTable.insert(typeDecl->name, true, typeDecl);
 	}
 	else {
 		if(!typeDecl->type->accept(this, phase)) {
@@ -119,27 +116,25 @@ bool NameResolver::visit(AstTypeDecl* typeDecl, Phase phase) {
 bool NameResolver::visit(AstStructDecl* structDecl, Phase phase) {
 	if(phase == Phase::HEAD) {
 		if(!isNameValid(structDecl->name)) {
-			Logger::getInstance().error("Name error: Struct %s%s redeclared!", structDecl->name.c_str(), depth);
+			Diagnostics::error("N004", structDecl->loc, "Struct %s redeclared", structDecl->name);
 			return false;
 		}
-		symbolTable.push_back({ structDecl->name, true, depth , structDecl});
+		symbolTable.insert(structDecl->name, true, structDecl);
 	}
 	else {
-		depth++;
+		symbolTable.enterScope();
+		bool result = true;
 
 		for(auto& decl : structDecl->fields) {
-			if(!decl.accept(this, Phase::HEAD))
-				return false;
+			result = decl.accept(this, Phase::HEAD) && result;
 		}
 
 		for(auto& decl : structDecl->fields) {
-			if(!decl.accept(this, Phase::BODY))
-				return false;
+			result = decl.accept(this, Phase::BODY) && result;
 		}
 
-		depth--;
-
-		clearSymbolDepth();
+		symbolTable.exitScope();
+		return result;
 	}
 
 	return true;
@@ -156,7 +151,7 @@ bool NameResolver::visit(AstNamedType* namedType, Phase phase) {
 		AstDecl* decl = findDecl(namedType->name, true);
 
 		if(decl == nullptr) {
-			Logger::getInstance().error("Name error: Type %s%s not found!", namedType->name.c_str(), namedType->loc.toString().c_str());
+			Diagnostics::error("N005", namedType->loc, "Type %s not found", namedType->name);
 			return false;
 		}
 
@@ -202,7 +197,7 @@ bool NameResolver::visit(AstNamedExpr* namedExpr, Phase phase) {
 		AstDecl* decl = findDecl(namedExpr->name, false);
 
 		if(decl == nullptr) {
-			Logger::getInstance().error("Name error: Variable %s%s not found!", namedExpr->name.c_str(), namedExpr->loc.toString().c_str());
+			Diagnostics::error("N006", namedExpr->loc, "Variable %s not found", namedExpr->name);
 			return false;
 		}
 
@@ -216,20 +211,23 @@ bool NameResolver::visit(AstNamedExpr* namedExpr, Phase phase) {
 bool NameResolver::visit(AstCallExpr* callExpr, Phase phase) {
 	if(phase == Phase::BODY) {
 		AstDecl* decl = findDecl(callExpr->name, false);
+		bool result = true;
 
 		if(decl == nullptr) {
-			Logger::getInstance().error("Name error: Function %s%s not found!", callExpr->name.c_str(), callExpr->loc.toString().c_str());
-			return false;
+			Diagnostics::error("N007", callExpr->loc, "Function %s not found", callExpr->name);
+			result = false;
+		}
+		else {
+			callExpr->declaration = decl;
+			Logger::getInstance().log("Found function %s%s!", decl->prettyToString().c_str(), callExpr->loc.toString().c_str());
 		}
 
-		callExpr->declaration = decl;
-		Logger::getInstance().log("Found function %s%s!", decl->prettyToString().c_str(), callExpr->loc.toString().c_str());
-
+		// the arguments are checked even if the function is unknown
 		for(auto& expr : callExpr->args) {
-			if(!expr->accept(this, phase)) {
-				return false;
-			}
+			result = expr->accept(this, phase) && result;
 		}
+
+		return result;
 	}
 
 	return true;
@@ -275,10 +273,17 @@ bool NameResolver::visit(AstPostfixExpr* postfixExpr, Phase phase) {
 
 bool NameResolver::visit(AstBinaryExpr* binaryExpr, Phase phase) {
 	if(phase == Phase::BODY) {
-		if(!binaryExpr->left->accept(this, phase)) {
-			return false;
-		}
-		if(!binaryExpr->right->accept(this, phase)) {
+		bool left = binaryExpr->left->accept(this, phase);
+		bool right = binaryExpr->right->accept(this, phase);
+		return left && right;
+	}
+
+	return true;
+}
+
+bool NameResolver::visit(AstSizeofExpr* sizeofExpr, Phase phase) {
+	if(phase == Phase::BODY) {
+		if(!sizeofExpr->type->accept(this, phase)) {
 			return false;
 		}
 	}
@@ -299,50 +304,37 @@ bool NameResolver::visit(AstExprStmt* exprStmt, Phase phase) {
 
 bool NameResolver::visit(AstAssignStmt* assignStmt, Phase phase) {
 	if(phase == Phase::BODY) {
-		if(!assignStmt->left->accept(this, phase)) {
-			return false;
-		}
-		if(!assignStmt->right->accept(this, phase)) {
-			return false;
-		}
+		bool left = assignStmt->left->accept(this, phase);
+		bool right = assignStmt->right->accept(this, phase);
+		return left && right;
 	}
 
 	return true;
 }
 
 bool NameResolver::visit(AstCompStmt* compStmt, Phase phase) {
-	depth++;
-
-	for(auto& stmt : compStmt->stmts) {
-		if(!stmt->accept(this, Phase::BODY)) {
-			return false;
-		}
-
-		if(!stmt->accept(this, Phase::HEAD)) {
-			return false;
-		}
+	// statements are visited with BODY and then HEAD, a block only opens its scope once
+	if(phase == Phase::HEAD) {
+		return true;
 	}
 
-	depth--;
-
-	clearSymbolDepth();
+	symbolTable.enterScope();
+	bool result = resolveStmts(compStmt->stmts);
+	symbolTable.exitScope();
 
-	return true;
+	return result;
 }
 
 bool NameResolver::visit(AstIfStmt* ifStmt, Phase phase) {
 	if(phase == Phase::BODY) {
-		if(!ifStmt->cond->accept(this, phase)) {
-			return false;
-		}
+		bool result = ifStmt->cond->accept(this, phase);
+		result = ifStmt->stmt->accept(this, phase) && result;
 
-		if(!ifStmt->stmt->accept(this, phase)) {
-			return false;
+		if(ifStmt->elseStmt) {
+			result = ifStmt->elseStmt->accept(this, phase) && result;
 		}
 
-		if(ifStmt->elseStmt && !ifStmt->elseStmt->accept(this, phase)) {
-			return false;
-		}
+		return result;
 	}
 
 	return true;
@@ -350,13 +342,8 @@ bool NameResolver::visit(AstIfStmt* ifStmt, Phase phase) {
 
 bool NameResolver::visit(AstWhileStmt* whileStmt, Phase phase) {
 	if(phase == Phase::BODY) {
-		if(!whileStmt->cond->accept(this, phase)) {
-			return false;
-		}
-
-		if(!whileStmt->stmt->accept(this, phase)) {
-			return false;
-		}
+		bool result = whileStmt->cond->accept(this, phase);
+		return whileStmt->stmt->accept(this, phase) && result;
 	}
 
 	return true;
@@ -1,14 +1,17 @@
 #pragma once
 #include "Visitor.h"
+#include "SymbTable.h"
 
 class NameResolver : public Visitor {
 private:
-	void clearSymbolDepth(); // remove all symb with depth > this->depth
 	bool isNameValid(const std::string& name, bool type = false);
 	AstDecl* findDecl(const std::string& name, bool type = false);
+	bool resolveStmts(std::vector<AstStmt*>& stmts);
 
-	int depth = 0;
+	const SymbTable* globals;	// frozen after the HEAD phase, shared between resolvers
 public:
+	NameResolver(const SymbTable* globals = nullptr) : globals(globals) {}
+
 	bool visit(AstVarDecl* varDecl, Phase phase) override;
 	bool visit(AstParDecl* parDecl, Phase phase) override;
 	bool visit(AstFunDecl* funDecl, Phase phase) override;
@@ -27,6 +30,7 @@ public:
 	bool visit(AstPrefixExpr* prefixExpr, Phase phase) override;
 	bool visit(AstPostfixExpr* postfixExpr, Phase phase) override;
 	bool visit(AstBinaryExpr* binaryExpr, Phase phase) override;
+	bool visit(AstSizeofExpr* sizeofExpr, Phase phase) override;
 
 	bool visit(AstExprStmt* exprStmt, Phase phase) override;
 	bool visit(AstAssignStmt* assignStmt, Phase phase) override;
@@ -37,5 +41,5 @@ public:
 	bool visit(AstVarStmt* varStmt, Phase phase) override;
 	bool visit(AstFunStmt* funStmt, Phase phase) override;
 public:
-	std::vector<Symb> symbolTable;
+	SymbTable symbolTable;
 };
@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include "Ast.h"
+
+// What a binary operator yields for a given pair of operand types
+enum class OperatorResult : unsigned char {
+	INVALID,	// operands not allowed
+	LEFT,		// type of the left operand
+	RIGHT,		// type of the right operand
+	BOOL		// canonical bool
+};
+
+namespace OperatorTable {
+	constexpr int TYPES = AstType::ARRAY + 1;
+
+	constexpr AstBinaryExpr::Binary binaryOps[] = {
+		AstBinaryExpr::PLUS, AstBinaryExpr::MINUS, AstBinaryExpr::MUL, AstBinaryExpr::DIV, AstBinaryExpr::MOD,
+		AstBinaryExpr::EQU, AstBinaryExpr::NEQ, AstBinaryExpr::LESS, AstBinaryExpr::LESS_EQU, AstBinaryExpr::GREATER, AstBinaryExpr::GREATER_EQU,
+		AstBinaryExpr::AND, AstBinaryExpr::OR, AstBinaryExpr::XOR,
+		AstBinaryExpr::ANDAND, AstBinaryExpr::OROR
+	};
+	constexpr int OPS = sizeof(binaryOps) / sizeof(binaryOps[0]);
+
+	// the Binary enum mirrors token values and has gaps, so rows are indexed separately
+	constexpr int binaryIndex(AstBinaryExpr::Binary op) {
+		for(int i = 0; i < OPS; i++) {
+			if(binaryOps[i] == op) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	using Table = std::array<std::array<std::array<OperatorResult, TYPES>, TYPES>, OPS>;
+
+	constexpr void allow(Table& table, AstBinaryExpr::Binary op, AstType::Type left, AstType::Type right, OperatorResult result) {
+		table[binaryIndex(op)][left][right] = result;
+	}
+
+	constexpr Table makeBinaryTable() {
+		Table table{};
+
+		for(AstBinaryExpr::Binary op : { AstBinaryExpr::PLUS, AstBinaryExpr::MINUS, AstBinaryExpr::MUL, AstBinaryExpr::DIV, AstBinaryExpr::MOD }) {
+			allow(table, op, AstType::INT, AstType::INT, OperatorResult::LEFT);
+			allow(table, op, AstType::FLOAT, AstType::FLOAT, OperatorResult::LEFT);
+			allow(table, op, AstType::PTR, AstType::INT, OperatorResult::LEFT);
+			allow(table, op, AstType::INT, AstType::PTR, OperatorResult::RIGHT);
+			allow(table, op, AstType::CHAR, AstType::INT, OperatorResult::LEFT);
+			allow(table, op, AstType::INT, AstType::CHAR, OperatorResult::RIGHT);
+		}
+
+		// pointer comparisons additionally need matching pointee types
+		for(AstBinaryExpr::Binary op : { AstBinaryExpr::EQU, AstBinaryExpr::NEQ, AstBinaryExpr::LESS, AstBinaryExpr::LESS_EQU, AstBinaryExpr::GREATER, AstBinaryExpr::GREATER_EQU }) {
+			allow(table, op, AstType::INT, AstType::INT, OperatorResult::BOOL);
+			allow(table, op, AstType::FLOAT, AstType::FLOAT, OperatorResult::BOOL);
+			allow(table, op, AstType::PTR, AstType::PTR, OperatorResult::BOOL);
+			allow(table, op, AstType::CHAR, AstType::CHAR, OperatorResult::BOOL);
+		}
+
+		for(AstBinaryExpr::Binary op : { AstBinaryExpr::AND, AstBinaryExpr::OR, AstBinaryExpr::XOR }) {
+			allow(table, op, AstType::INT, AstType::INT, OperatorResult::LEFT);
+		}
+
+		for(AstBinaryExpr::Binary op : { AstBinaryExpr::ANDAND, AstBinaryExpr::OROR }) {
+			allow(table, op, AstType::BOOL, AstType::BOOL, OperatorResult::LEFT);
+		}
+
+		return table;
+	}
+
+	constexpr Table binaryTable = makeBinaryTable();
+
+	constexpr OperatorResult binaryResult(AstBinaryExpr::Binary op, AstType::Type left, AstType::Type right) {
+		return binaryTable[binaryIndex(op)][left][right];
+	}
+
+	// resolves the result type of op applied to the given operands, nullptr if not allowed
+	inline AstType* binaryType(AstBinaryExpr::Binary op, AstType* left, AstType* right) {
+		switch(binaryResult(op, left->type, right->type)) {
+			case OperatorResult::LEFT: return left;
+			case OperatorResult::RIGHT: return right;
+			case OperatorResult::BOOL: return AstAtomType::canonical(AstType::BOOL);
+			default: return nullptr;
+		}
+	}
+}
+
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::PLUS, AstType::INT, AstType::INT) == OperatorResult::LEFT, "int + int is int");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::MINUS, AstType::INT, AstType::PTR) == OperatorResult::RIGHT, "int - ptr is ptr");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::MUL, AstType::CHAR, AstType::CHAR) == OperatorResult::INVALID, "char * char is not allowed");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::MOD, AstType::INT, AstType::FLOAT) == OperatorResult::INVALID, "no implicit int to float");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::LESS, AstType::FLOAT, AstType::FLOAT) == OperatorResult::BOOL, "comparisons are bool");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::EQU, AstType::BOOL, AstType::BOOL) == OperatorResult::INVALID, "bools can't be compared");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::XOR, AstType::INT, AstType::INT) == OperatorResult::LEFT, "bitwise ops are int only");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::OROR, AstType::BOOL, AstType::BOOL) == OperatorResult::LEFT, "logical ops are bool only");
+static_assert(OperatorTable::binaryResult(AstBinaryExpr::ANDAND, AstType::INT, AstType::INT) == OperatorResult::INVALID, "no implicit int to bool");
@@ -0,0 +1,121 @@
+#include "Protocol.h"
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+
+static void putUint32(std::string& out, uint32_t value) {
+	for(int i = 0; i < 4; i++) {
+		out += (char)((value >> (8 * i)) & 0xff);
+	}
+}
+
+static uint32_t getUint32(const char* data) {
+	uint32_t value = 0;
+	for(int i = 0; i < 4; i++) {
+		value |= (uint32_t)(unsigned char)data[i] << (8 * i);
+	}
+	return value;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+	while(size > 0) {
+		// a client that went away must not kill the server with SIGPIPE
+		ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+		if(written < 0 && errno == EINTR) {
+			continue;
+		}
+		if(written <= 0) {
+			return false;
+		}
+
+		data += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+static bool readAll(int fd, char* data, size_t size) {
+	while(size > 0) {
+		ssize_t count = read(fd, data, size);
+		if(count < 0 && errno == EINTR) {
+			continue;
+		}
+		if(count <= 0) {
+			return false;
+		}
+
+		data += count;
+		size -= count;
+	}
+
+	return true;
+}
+
+bool Protocol::writeFrame(int fd, const std::string& payload) {
+	std::string header;
+	putUint32(header, payload.size());
+
+	return writeAll(fd, header.data(), header.size()) && writeAll(fd, payload.data(), payload.size());
+}
+
+bool Protocol::readFrame(int fd, std::string& payload) {
+	char header[4];
+	if(!readAll(fd, header, sizeof(header))) {
+		return false;
+	}
+
+	uint32_t size = getUint32(header);
+	if(size > MAX_FRAME) {
+		return false;
+	}
+
+	payload.resize(size);
+	return readAll(fd, &payload[0], size);
+}
+
+std::string Protocol::encodeRequest(const std::string& cwd, const std::vector<std::string>& args) {
+	std::string payload = cwd;
+	payload += '\0';
+
+	for(const std::string& arg : args) {
+		payload += arg;
+		payload += '\0';
+	}
+
+	return payload;
+}
+
+bool Protocol::decodeRequest(const std::string& payload, std::string& cwd, std::vector<std::string>& args) {
+	if(payload.empty() || payload.back() != '\0') {
+		return false;
+	}
+
+	std::vector<std::string> fields;
+	for(size_t start = 0; start < payload.size(); ) {
+		size_t end = payload.find('\0', start);
+		fields.push_back(payload.substr(start, end - start));
+		start = end + 1;
+	}
+
+	cwd = fields[0];
+	args.assign(fields.begin() + 1, fields.end());
+	return true;
+}
+
+std::string Protocol::encodeResponse(int status, const std::string& output) {
+	std::string payload;
+	putUint32(payload, (uint32_t)status);
+	return payload + output;
+}
+
+bool Protocol::decodeResponse(const std::string& payload, int& status, std::string& output) {
+	if(payload.size() < 4) {
+		return false;
+	}
+
+	status = (int)getUint32(payload.data());
+	output = payload.substr(4);
+	return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Framing used between the compile server and its clients. Every message is a
+// 4 byte little-endian payload length followed by the payload. A connection carries
+// one request and its response.
+//
+// request:  working directory and arguments, each terminated by '\0'
+// response: 4 byte little-endian exit status followed by the compiler output
+namespace Protocol {
+	const size_t MAX_FRAME = 64 << 20;
+
+	bool writeFrame(int fd, const std::string& payload);
+	bool readFrame(int fd, std::string& payload);	// false on EOF, errors and oversized frames
+
+	std::string encodeRequest(const std::string& cwd, const std::vector<std::string>& args);
+	bool decodeRequest(const std::string& payload, std::string& cwd, std::vector<std::string>& args);
+
+	std::string encodeResponse(int status, const std::string& output);
+	bool decodeResponse(const std::string& payload, int& status, std::string& output);
+}
@@ -0,0 +1,61 @@
+#include "ResultCache.h"
+#include "Driver.h"
+#include <sys/stat.h>
+
+bool ResultCache::makeKey(const std::string& path, const Options& options, std::string& key) {
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0) {
+		return false;
+	}
+
+	key = path;
+	key += '\0' + std::to_string(info.st_mtim.tv_sec) + '.' + std::to_string(info.st_mtim.tv_nsec);
+	key += '\0' + std::to_string(info.st_size);
+	key += '\0' + std::to_string((int)options.stopAfter);
+	key += options.dumpTokens ? 't' : '-';
+	key += options.dumpAst ? 'a' : '-';
+	key += options.dumpIr ? 'i' : '-';
+	key += options.optimize ? 'O' : '-';
+	key += options.optReport ? 'r' : '-';
+	key += options.check ? 'c' : '-';
+	key += options.output.empty() ? '-' : 'o';
+	key += options.color ? 'C' : '-';
+	key += options.debug ? 'd' : '-';
+	key += '\0' + std::to_string(options.maxErrors);
+	return true;
+}
+
+bool ResultCache::find(const std::string& key, Entry& entry) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto it = entries.find(key);
+	if(it == entries.end()) {
+		misses++;
+		return false;
+	}
+
+	hits++;
+	recent.splice(recent.begin(), recent, it->second);
+	entry = it->second->second;
+	return true;
+}
+
+void ResultCache::store(const std::string& key, const Entry& entry) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto it = entries.find(key);
+	if(it != entries.end()) {
+		it->second->second = entry;
+		recent.splice(recent.begin(), recent, it->second);
+		return;
+	}
+
+	// stale versions of edited files are never hit again and fall off the end
+	if(entries.size() >= MAX_ENTRIES) {
+		entries.erase(recent.back().first);
+		recent.pop_back();
+	}
+
+	recent.emplace_front(key, entry);
+	entries[key] = recent.begin();
+}
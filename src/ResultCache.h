@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+
+struct Options;
+
+// Outcome of compiling one file, reused while the file stays unchanged.
+// Entries are keyed by path, modification time, size and every option that
+// changes what compiling the file prints. Once full, the least recently used
+// entry makes room.
+class ResultCache {
+public:
+	struct Entry {
+		std::string log;
+		std::string dumps;
+		bool success;
+	};
+
+	static const size_t MAX_ENTRIES = 4096;
+
+private:
+	std::mutex lock;
+	std::list<std::pair<std::string, Entry>> recent;	// most recently used first
+	std::unordered_map<std::string, std::list<std::pair<std::string, Entry>>::iterator> entries;
+	size_t hits = 0;
+	size_t misses = 0;
+
+public:
+	// false if the file can't be stat'ed, it is then compiled without caching
+	static bool makeKey(const std::string& path, const Options& options, std::string& key);
+
+	bool find(const std::string& key, Entry& entry);
+	void store(const std::string& key, const Entry& entry);
+
+	size_t getHits() const { return hits; }
+	size_t getMisses() const { return misses; }
+};
@@ -1,32 +1,101 @@
 #include "Seman.h"
+#include "ThreadPool.h"
+#include "MemoryStats.h"
+#include "Diagnostics.h"
+#include "Trace.h"
 
 
 bool Seman::resolveNames() {
 	Logger::getInstance().log("#i#grnPhase 3.1: Name Resolving#r\n");
 
-	for(auto& decl : decls) {
-		if(!decl->accept(&nameResolver, Phase::HEAD)) {
-			return false;
+	// every global is checked, so one run reports all redeclarations
+	bool result = true;
+	{
+		TRACE_SCOPE("declare globals");
+		for(auto& decl : decls) {
+			result = decl->accept(&nameResolver, Phase::HEAD) && result;
 		}
 	}
 
-	for(auto& decl : decls) {
-		if(!decl->accept(&nameResolver, Phase::BODY)) {
-			return false;
-		}
-	}
+	symbolCount = nameResolver.symbolTable.getInserted();
 
-	return true;
+	// globals are read-only from here on, so every body gets its own resolver
+	bool bodies = resolveBodies("resolve names", [this](AstDecl* decl) {
+		NameResolver resolver(&nameResolver.symbolTable);
+		bool result = decl->accept(&resolver, Phase::BODY);
+
+		symbolCount += resolver.symbolTable.getInserted();
+		return result;
+	});
+
+	return result && bodies;
 }
 
 bool Seman::resolveTypes() {
 	Logger::getInstance().log("#i#grnPhase 3.2: Type Resolving#r\n");
 
-	for(auto& decl : decls) {
-		if(!decl->accept(&typeResolver, Phase::HEAD)) {
-			return false;
+	bool result = true;
+	{
+		TRACE_SCOPE("resolve signatures");
+		for(auto& decl : decls) {
+			result = decl->accept(&typeResolver, Phase::HEAD) && result;
+		}
+	}
+
+	// bodies only depend on the signatures resolved above
+	bool bodies = resolveBodies("resolve types", [](AstDecl* decl) {
+		TypeResolver resolver;
+		return decl->accept(&resolver, Phase::BODY);
+	});
+
+	if(!result || !bodies) {
+		return false;
+	}
+
+	// folded nodes reuse the resolved types, so folding runs after type checking
+	{
+		TRACE_SCOPE("fold constants");
+		for(auto& decl : decls) {
+			decl->accept(&constFolder, Phase::BODY);
+		}
+	}
+
+	// hashes depend on resolved declarations, so they are computed last
+	{
+		TRACE_SCOPE("hash expressions");
+		for(auto& decl : decls) {
+			decl->accept(&exprHasher, Phase::BODY);
 		}
 	}
 
 	return true;
 }
+
+bool Seman::resolveBodies(const char* name, const std::function<bool(AstDecl*)>& resolve) {
+	std::vector<std::string> output(decls.size());
+	std::vector<Diagnostics> diagnostics(decls.size());
+	std::vector<char> resolved(decls.size());
+	MemoryStats::Phase phase = MemoryStats::getPhase();
+	Diagnostics* collector = Diagnostics::collector();
+
+	ThreadPool::getInstance().parallelFor(decls.size(), [&](size_t i) {
+		MemoryScope memory(phase);
+		TRACE_SCOPE(name, decls[i]->getName());
+		std::string* previous = Logger::getInstance().capture(&output[i]);
+		Diagnostics* previousCollector = Diagnostics::collect(collector ? &diagnostics[i] : nullptr);
+		resolved[i] = resolve(decls[i]);
+		Diagnostics::collect(previousCollector);
+		Logger::getInstance().capture(previous);
+	});
+
+	bool result = true;
+	for(size_t i = 0; i < decls.size(); i++) {
+		Logger::getInstance().write(output[i]);
+		if(collector) {
+			collector->merge(diagnostics[i]);
+		}
+		result = result && resolved[i];
+	}
+
+	return result;
+}
@@ -1,22 +1,34 @@
 #pragma once
 #include <vector>
+#include <functional>
+#include <atomic>
 #include "Logger.h"
 #include "Synan.h"
 #include "NameResolver.h"
 #include "TypeResolver.h"
+#include "ExprHasher.h"
+#include "ConstFolder.h"
 
 class Seman {
 public:
-	Seman(Synan& synan) : decls(synan.getDecls()) {
+	Seman(Synan& synan) : decls(synan.getDecls()), constFolder(&synan.getExprs()) {
 		Logger::getInstance().log("#i#grnPhase 3: Semantic analysis#r\n");
 	}
 
 	bool resolveNames();
 	bool resolveTypes();
 
+	size_t getSymbolCount() const { return symbolCount; }
+
 private:
+	// runs every declaration's BODY phase as its own task, output is replayed in source order
+	bool resolveBodies(const char* name, const std::function<bool(AstDecl*)>& resolve);
+
 	std::vector<AstDecl*>& decls;
+	std::atomic<size_t> symbolCount { 0 };
 	
 	NameResolver nameResolver;
 	TypeResolver typeResolver;
+	ConstFolder constFolder;
+	ExprHasher exprHasher;
 };
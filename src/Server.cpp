@@ -0,0 +1,123 @@
+#include "Server.h"
+#include "Driver.h"
+#include "Protocol.h"
+#include "Logger.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static std::string absolute(const std::string& cwd, const std::string& path) {
+	if(path.empty() || path[0] == '/') {
+		return path;
+	}
+	return cwd + "/" + path;
+}
+
+int Server::run() {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+
+	if(path.size() >= sizeof(address.sun_path)) {
+		Logger::getInstance().error("Socket path %s is too long", path.c_str());
+		return -1;
+	}
+	strcpy(address.sun_path, path.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0) {
+		Logger::getInstance().error("Cannot create socket: %s", strerror(errno));
+		return -1;
+	}
+
+	// a socket left behind by a previous server
+	unlink(path.c_str());
+
+	if(bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 16) != 0) {
+		Logger::getInstance().error("Cannot listen on %s: %s", path.c_str(), strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	Logger::getInstance().log("Serving on %s", path.c_str());
+	Logger::getInstance().flush();
+
+	while(true) {
+		int client = accept(fd, nullptr, nullptr);
+		if(client < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			Logger::getInstance().error("Accept failed: %s", strerror(errno));
+			break;
+		}
+
+		// requests share the logger and the time report, so they run one at a time,
+		// each of them still compiles its files in parallel. A connection carries a
+		// single request, and a client that doesn't send it in time is dropped, so
+		// one client can't hold up the others.
+		timeval timeout = { REQUEST_TIMEOUT, 0 };
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		serve(client);
+		close(client);
+	}
+
+	close(fd);
+	unlink(path.c_str());
+	return -1;
+}
+
+void Server::serve(int client) {
+	std::string request;
+	if(!Protocol::readFrame(client, request)) {
+		return;
+	}
+
+	std::string output;
+	int status = handle(request, output);
+	Protocol::writeFrame(client, Protocol::encodeResponse(status, output));
+}
+
+int Server::handle(const std::string& request, std::string& output) {
+	std::string* previous = Logger::getInstance().capture(&output);
+
+	std::string cwd;
+	std::vector<std::string> args;
+	Options options;
+	int status = -1;
+
+	if(!Protocol::decodeRequest(request, cwd, args)) {
+		Logger::getInstance().error("Malformed request");
+	}
+	else if(Driver::parseOptions(args, options) && options.server.empty() && !options.help) {
+		if(!options.logFile.empty()) {
+			// the output goes back to the client, which can redirect it itself
+			Logger::getInstance().error("--log-file is not supported by the server");
+		}
+		else {
+			// paths are relative to the client, not to the server
+			for(std::string& input : options.inputs) {
+				input = absolute(cwd, input);
+			}
+			if(!options.output.empty()) {
+				options.output = absolute(cwd, options.output);
+			}
+			if(!options.trace.empty()) {
+				options.trace = absolute(cwd, options.trace);
+			}
+			if(!options.cacheDir.empty()) {
+				options.cacheDir = absolute(cwd, options.cacheDir);
+			}
+
+			Driver driver(options, &cache);
+			status = driver.run();
+		}
+	}
+
+	Logger::getInstance().capture(previous);
+	Logger::getInstance().setQuiet(false);
+	return status;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include "ResultCache.h"
+
+// Resident compiler serving requests over a Unix domain socket (see Protocol.h).
+// The thread pool and the cache of compiled files stay warm between requests,
+// unchanged files are answered from the cache without being read.
+class Server {
+private:
+	static const int REQUEST_TIMEOUT = 10;		// seconds a client has to send its request
+
+	std::string path;
+	ResultCache cache;
+
+	void serve(int client);
+	int handle(const std::string& request, std::string& output);
+
+public:
+	Server(const std::string& path) : path(path) {}
+
+	// accepts clients until the process is killed, returns only on setup errors
+	int run();
+};
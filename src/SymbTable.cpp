@@ -0,0 +1,52 @@
+#include "SymbTable.h"
+
+void SymbTable::enterScope() {
+	scopeStarts.push_back(symbols.size());
+}
+
+void SymbTable::exitScope() {
+	size_t start = scopeStarts.back();
+	scopeStarts.pop_back();
+
+	while(symbols.size() > start) {
+		Entry& entry = symbols.back();
+		auto& scope = names[entry.symb.isType];
+
+		if(entry.shadowed < 0) {
+			scope.erase(entry.symb.name);
+		}
+		else {
+			scope[entry.symb.name] = entry.shadowed;
+		}
+		symbols.pop_back();
+	}
+}
+
+void SymbTable::insert(const std::string& name, bool type, AstDecl* decl) {
+	auto result = names[type].emplace(name, symbols.size());
+	int shadowed = -1;
+
+	if(!result.second) {
+		shadowed = result.first->second;
+		result.first->second = symbols.size();
+	}
+
+	symbols.push_back({ { name, type, getDepth(), decl }, shadowed });
+	inserted++;
+}
+
+bool SymbTable::isDeclared(const std::string& name, bool type) const {
+	auto it = names[type].find(name);
+	size_t start = scopeStarts.empty() ? 0 : scopeStarts.back();
+
+	return it != names[type].end() && (size_t)it->second >= start;
+}
+
+AstDecl* SymbTable::find(const std::string& name, bool type) const {
+	auto it = names[type].find(name);
+	if(it == names[type].end()) {
+		return nullptr;
+	}
+
+	return symbols[it->second].symb.decl;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Visitor.h"
+
+// Scoped symbol table. Symbols are kept in declaration order, every name maps to
+// its innermost symbol which links to the one it shadows, and every open scope
+// remembers where it started. Lookups are O(1) and leaving a scope truncates
+// the table back to its start, touching only that scope's own symbols.
+class SymbTable {
+private:
+	struct Entry {
+		Symb symb;
+		int shadowed;	// previous symbol with the same name or -1
+	};
+
+	std::vector<Entry> symbols;
+	std::unordered_map<std::string, int> names[2];	// indexed by Symb::isType
+	std::vector<size_t> scopeStarts;
+	size_t inserted = 0;
+
+public:
+	void enterScope();
+	void exitScope();
+	int getDepth() const { return scopeStarts.size(); }
+
+	void insert(const std::string& name, bool type, AstDecl* decl);
+	bool isDeclared(const std::string& name, bool type) const; // in the current scope
+	AstDecl* find(const std::string& name, bool type) const;
+
+	size_t size() const { return symbols.size(); }
+	size_t getInserted() const { return inserted; }	// including symbols of closed scopes
+};
@@ -1,4 +1,6 @@
 #include "Synan.h"
+#include "Diagnostics.h"
+#include "Trace.h"
 
 
 
@@ -15,8 +17,15 @@ Synan::~Synan() {
 
 bool Synan::parse() {
 	while(pos < tokens.size()) {
-		if(!isDecl()) {
-			Logger::getInstance().error("Syntax error at line %d[%d].", tokens[pos].getLine(), tokens[pos].getStart());
+		TraceScope trace("parse declaration");
+
+		if(isDecl()) {
+			trace.setDetail(decls.back()->getName());
+		}
+		else {
+			if(tooDeep)
+				return false;
+			Diagnostics::error("S001", tokens[pos].getLocation(), "Unexpected %s", tokens[pos].getName());
 			return false;
 		}
 	}
@@ -24,27 +33,37 @@ bool Synan::parse() {
 	return true;
 }
 
-void Synan::printDecls() {
+void Synan::expectedSemicolon() {
+	// backtracking out of a too deep nesting, whatever is left is no real error
+	if(tooDeep)
+		return;
+
+	// reported right after the last token that still belongs to the statement
+	int column = tokens[pos - 1].getEnd() + 1;
+	Diagnostics::error("S002", Location(tokens[pos - 1].getLine(), column, column), "Expected ';'");
+}
+
+void Synan::printDecls(std::ostream& out) {
 	for(AstDecl* decl : decls) {
-		std::cout << decl->prettyToString() << std::endl;
+		out << decl->prettyToString() << std::endl;
 	}
 }
 
 bool Synan::isDecl() {
 	if(isFunDecl()) {
-		Logger::getInstance().debug("Fun decl");
+		LOG_DEBUG("Fun decl");
 		return true;
 	}
 	else if(isVarDecl()) {
-		Logger::getInstance().debug("Var decl");
+		LOG_DEBUG("Var decl");
 		return true;
 	}
 	else if(isTypeDecl()) {
-		Logger::getInstance().debug("Type decl");
+		LOG_DEBUG("Type decl");
 		return true;
 	}
 	else if(isStructDecl()) {
-		Logger::getInstance().debug("Struct decl");
+		LOG_DEBUG("Struct decl");
 		return true;
 	}
 	
@@ -64,7 +83,7 @@ bool Synan::isVarDecl() {
 		}
 
 		if(!isTokenType(Token::SEMICOLON)) {
-			Logger::getInstance().error("Syntax error at line %d: expected ';'", tokens[pos-1].getLine());
+			expectedSemicolon();
 			pos = oldPos;
 			return false;
 		}
@@ -114,7 +133,7 @@ bool Synan::isFunDecl() {
 				temp->loc.end = stmts.back()->loc.end;
 
 				currentFunction = prev;
-				Logger::getInstance().debug("Compound stmt");
+				LOG_DEBUG("Compound stmt");
 				return true;
 			}
 
@@ -137,7 +156,7 @@ bool Synan::isParDecl() {
 			varDecls.push_back(AstVarDecl({type->loc.line, type->loc.start, tokens[pos - 1].getEnd() }, tokens[pos - 1].getText(), types.back()));
 		}
 
-		Logger::getInstance().debug("Par decl");
+		LOG_DEBUG("Par decl");
 		decls.push_back(new AstParDecl({ type->loc.line, type->loc.start, tokens[pos - 1].getEnd() }, varDecls));
 		return true;
 	}
@@ -150,7 +169,7 @@ bool Synan::isTypeDecl() {
 
 	if(isTokenType(Token::TYPEDEF) && isType() && isTokenType(Token::IDENTIFIER)) {
 		if(!isTokenType(Token::SEMICOLON)) {
-			Logger::getInstance().error("Syntax error at line %d: expected ';'", tokens[pos-1].getLine());
+			expectedSemicolon();
 			pos = oldPos;
 			return false;
 		}
@@ -189,15 +208,15 @@ bool Synan::isStructDecl() {
 
 bool Synan::isType() {
 	if(isPtrOrArrType()) {
-		Logger::getInstance().debug("Ptr or arr type");
+		LOG_DEBUG("Ptr or arr type");
 		return true;
 	}
 	else if(isAtomicType()) {
-		Logger::getInstance().debug("Atomic type");
+		LOG_DEBUG("Atomic type");
 		return true;
 	}
 	else if(isNamedType()) {
-		Logger::getInstance().debug("Named type");
+		LOG_DEBUG("Named type");
 		return true;
 	}
 
@@ -278,7 +297,7 @@ bool Synan::isPtrOrArrType() {
 
 bool Synan::isExpr() {
 	if(isInfixExpr()) {
-		Logger::getInstance().debug("XFix expr");
+		LOG_DEBUG("XFix expr");
 		return true;
 	}
 
@@ -347,7 +366,22 @@ bool Synan::isFunctionCall() {
 bool Synan::isEnclosedExpr() {
 	int oldPos = pos;
 
-	if(isTokenType(Token::LPAREN) && isExpr() && isTokenType(Token::RPAREN)) {
+	if(isTokenType(Token::LPAREN)) {
+		Nested nested(*this);
+		if(nested.entered && isExpr() && isTokenType(Token::RPAREN)) {
+			return true;
+		}
+	}
+
+	pos = oldPos;
+	return false;
+}
+
+bool Synan::isSizeofExpr() {
+	int oldPos = pos;
+
+	if(isTokenType(Token::SIZEOF) && isTokenType(Token::LPAREN) && isType() && isTokenType(Token::RPAREN)) {
+		exprs.push_back(new AstSizeofExpr({ tokens[oldPos].getLine(), tokens[oldPos].getStart(), tokens[pos - 1].getEnd() }, types.back()));
 		return true;
 	}
 
@@ -367,7 +401,7 @@ bool Synan::isInfixExpr() {
 }
 
 bool Synan::isInfixA() {
-	Logger::getInstance().debug("Infix A: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix A: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	if(isInfixB() && isInfixB_()) {
 		return true;
 	}
@@ -376,25 +410,27 @@ bool Synan::isInfixA() {
 }
 
 bool Synan::isInfixA_() {
-	Logger::getInstance().debug("Infix A_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	if(isTokenType(Token::ANDAND) || isTokenType(Token::OROR)) {
+	LOG_DEBUG("Infix A_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	// a loop rather than recursion, so long flat chains don't use up the stack
+	Chain chain(*this);
+	while(isTokenType(Token::ANDAND) || isTokenType(Token::OROR)) {
+		if(!chain.add())
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		AstExpr* expr = exprs.back();
-		if(isInfixA()) {
-			Logger::getInstance().debug("Infix expr: binbin", pos);
-			exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
-			isInfixA_();
-			return true;
-		}
+		if(!isInfixA())
+			return false;
 
-		return false;
-	} 
+		LOG_DEBUG("Infix expr: binbin", pos);
+		exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
+	}
 
 	return true;
 }
 
 bool Synan::isInfixB() {
-	Logger::getInstance().debug("Infix B: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix B: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	if(isInfixC() && isInfixC_()) {
 		return true;
 	}
@@ -402,25 +438,26 @@ bool Synan::isInfixB() {
 }
 
 bool Synan::isInfixB_() {
-	Logger::getInstance().debug("Infix B_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	if(isTokenType(Token::OR) || isTokenType(Token::AND) || isTokenType(Token::XOR)) {
+	LOG_DEBUG("Infix B_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	Chain chain(*this);
+	while(isTokenType(Token::OR) || isTokenType(Token::AND) || isTokenType(Token::XOR)) {
+		if(!chain.add())
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		AstExpr* expr = exprs.back();
-		if(isInfixB()) {
-			Logger::getInstance().debug("Infix expr: bin", pos);
-			exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
-			isInfixB_();
-			return true;
-		}
+		if(!isInfixB())
+			return false;
 
-		return false;
+		LOG_DEBUG("Infix expr: bin", pos);
+		exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
 	}
 
 	return true;
 }
 
 bool Synan::isInfixC() {
-	Logger::getInstance().debug("Infix C: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix C: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	if(isInfixD() && isInfixD_()) {
 		return true;
 	}
@@ -428,25 +465,26 @@ bool Synan::isInfixC() {
 }
 
 bool Synan::isInfixC_() {
-	Logger::getInstance().debug("Infix C_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	if(isTokenType(Token::EQUAL) || isTokenType(Token::NOT_EQUAL) || isTokenType(Token::LESS_THAN) || isTokenType(Token::LESS_THAN_EQUAL) || isTokenType(Token::GREATER_THAN) || isTokenType(Token::GREATER_THAN_EQUAL)) {
+	LOG_DEBUG("Infix C_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	Chain chain(*this);
+	while(isTokenType(Token::EQUAL) || isTokenType(Token::NOT_EQUAL) || isTokenType(Token::LESS_THAN) || isTokenType(Token::LESS_THAN_EQUAL) || isTokenType(Token::GREATER_THAN) || isTokenType(Token::GREATER_THAN_EQUAL)) {
+		if(!chain.add())
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		AstExpr* expr = exprs.back();
-		if(isInfixC()) {
-			Logger::getInstance().debug("Infix expr: comp", pos);
-			exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
-			isInfixC_();
-			return true;
-		}
+		if(!isInfixC())
+			return false;
 
-		return false;
+		LOG_DEBUG("Infix expr: comp", pos);
+		exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
 	}
 
 	return true;
 }
 
 bool Synan::isInfixD() {
-	Logger::getInstance().debug("Infix D: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix D: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	if(isInfixE() && isInfixE_()) {
 		return true;
 	}
@@ -454,18 +492,19 @@ bool Synan::isInfixD() {
 }
 
 bool Synan::isInfixD_() {
-	Logger::getInstance().debug("Infix D_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	if(isTokenType(Token::PLUS) || isTokenType(Token::MINUS)) {
+	LOG_DEBUG("Infix D_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	Chain chain(*this);
+	while(isTokenType(Token::PLUS) || isTokenType(Token::MINUS)) {
+		if(!chain.add())
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		AstExpr* expr = exprs.back();
-		if(isInfixD()) {
-			Logger::getInstance().debug("Infix expr: add\n", pos);
-			exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
-			isInfixD_();
-			return true;
-		}
+		if(!isInfixD())
+			return false;
 
-		return false;
+		LOG_DEBUG("Infix expr: add\n", pos);
+		exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
 	}
 
 	return true;
@@ -474,7 +513,7 @@ bool Synan::isInfixD_() {
 bool Synan::isInfixE() {
 	int oldPos = pos;
 
-	Logger::getInstance().debug("Infix E: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix E: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	bool prefix = false;
 	if(isTokenType(Token::PLUS)
 		|| isTokenType(Token::MINUS)
@@ -485,23 +524,31 @@ bool Synan::isInfixE() {
 		|| isTokenType(Token::MULTIPLY)
 		|| isTokenType(Token::AND)) 
 	{
+		Nested nested(*this);
+		if(!nested.entered)
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		if(isInfixE()) {
 			AstExpr* expr = exprs.back();
 			exprs.pop_back();
 			exprs.push_back(new AstPrefixExpr({ tokens[oldPos].getLine(), tokens[oldPos].getStart(), expr->loc.end }, (AstPrefixExpr::Prefix)type, expr));
 
-			Logger::getInstance().debug("Prefix expr", pos);
+			LOG_DEBUG("Prefix expr", pos);
 			return true;
 		}
 	} else if (isTokenType(Token::LPAREN) && isType()) {
 		if(isTokenType(Token::RPAREN)){
 			AstType* type = types.back();
+			Nested nested(*this);
+			if(!nested.entered)
+				return false;
+
 
 			if(isInfixE()) {
 				AstExpr* expr = exprs.back();
 				exprs.push_back(new AstCastExpr({ tokens[oldPos].getLine(), tokens[oldPos].getStart(), expr->loc.end }, type, expr));
-				Logger::getInstance().debug("Cast expr", pos);
+				LOG_DEBUG("Cast expr", pos);
 				return true;
 			}	
 		}
@@ -517,25 +564,26 @@ bool Synan::isInfixE() {
 }
 
 bool Synan::isInfixE_() {
-	Logger::getInstance().debug("Infix E_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	if(isTokenType(Token::MULTIPLY) || isTokenType(Token::DIVIDE) || isTokenType(Token::MODULO)) { 
+	LOG_DEBUG("Infix E_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	Chain chain(*this);
+	while(isTokenType(Token::MULTIPLY) || isTokenType(Token::DIVIDE) || isTokenType(Token::MODULO)) {
+		if(!chain.add())
+			return false;
+
 		Token::TokenType type = tokens[pos - 1].getType();
 		AstExpr* expr = exprs.back();
-		if(isInfixE()) {
-			Logger::getInstance().debug("Infix Expr: mul", pos);
-			exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
-			isInfixE_();
-			return true;
-		}
+		if(!isInfixE())
+			return false;
 
-		return false;
+		LOG_DEBUG("Infix Expr: mul", pos);
+		exprs.push_back(new AstBinaryExpr({ expr->loc.line, expr->loc.start, exprs.back()->loc.end }, (AstBinaryExpr::Binary)type, expr, exprs.back()));
 	}
 
 	return true;
 }
 
 bool Synan::isInfixF() {
-	Logger::getInstance().debug("Infix F: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix F: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 	if(isInfixG() && isInfixG_()) {
 		return true;
 	}
@@ -543,38 +591,41 @@ bool Synan::isInfixF() {
 }
 
 bool Synan::isInfixG_() {
-	Logger::getInstance().debug("Infix G_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
-	AstExpr* expr = exprs.back();
+	LOG_DEBUG("Infix G_: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	Chain chain(*this);
 
-	if((isTokenType(Token::PPLUS) || isTokenType(Token::MMINUS))) {
-		exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 1].getType(), expr));
-		isInfixG_();
-	}
-	else if((isTokenType(Token::DOT) && isTokenType(Token::IDENTIFIER))) {
-		std::string name = tokens[pos - 1].getText();
-		exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 2].getType(), expr, name));
-		isInfixG_();
-	}
-	else if((isTokenType(Token::PTR) && isTokenType(Token::IDENTIFIER))) {
-		std::string name = tokens[pos - 1].getText();
-		exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 2].getType(), expr, name));
-		isInfixG_();
-	}
-	else if(isTokenType(Token::LBRACKET) && isExpr() && isTokenType(Token::RBRACKET)) {
-		AstExpr* index = exprs.back();
-		exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, AstPostfixExpr::ARRAYACCESS, expr, index));
-		isInfixG_();
-	}
-	
-	return true;
+	while(true) {
+		AstExpr* expr = exprs.back();
+
+		if((isTokenType(Token::PPLUS) || isTokenType(Token::MMINUS))) {
+			exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 1].getType(), expr));
+		}
+		else if((isTokenType(Token::DOT) && isTokenType(Token::IDENTIFIER))) {
+			std::string name = tokens[pos - 1].getText();
+			exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 2].getType(), expr, name));
+		}
+		else if((isTokenType(Token::PTR) && isTokenType(Token::IDENTIFIER))) {
+			std::string name = tokens[pos - 1].getText();
+			exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, (AstPostfixExpr::Postfix)tokens[pos - 2].getType(), expr, name));
+		}
+		else if(isTokenType(Token::LBRACKET) && isExpr() && isTokenType(Token::RBRACKET)) {
+			AstExpr* index = exprs.back();
+			exprs.push_back(new AstPostfixExpr({ expr->loc.line, expr->loc.start, tokens[pos - 1].getEnd() }, AstPostfixExpr::ARRAYACCESS, expr, index));
+		}
+		else {
+			return true;
+		}
 
+		if(!chain.add())
+			return false;
+	}
 }
 
 bool Synan::isInfixG() {
-	Logger::getInstance().debug("Infix G: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
+	LOG_DEBUG("Infix G: tokens[%d] = %s", pos, tokens[pos].getName().c_str());
 
-	if((isFunctionCall() || isConstExpr() || isVariableAccess() || isEnclosedExpr())) {
-		Logger::getInstance().debug("Infix const", pos);
+	if((isSizeofExpr() || isFunctionCall() || isConstExpr() || isVariableAccess() || isEnclosedExpr())) {
+		LOG_DEBUG("Infix const", pos);
 		return true;
 	}
 
@@ -584,41 +635,45 @@ bool Synan::isInfixG() {
 
 
 bool Synan::isStmt() {
+	Nested nested(*this);
+	if(!nested.entered)
+		return false;
+
 	if(isAssignStmt()) {
-		Logger::getInstance().debug("Assign stmt");
+		LOG_DEBUG("Assign stmt");
 		return true;
 	}
 	else if(isIfStmt()) {
-		Logger::getInstance().debug("If stmt");
+		LOG_DEBUG("If stmt");
 		return true;
 	}
 	else if(isWhileStmt()) {
-		Logger::getInstance().debug("While stmt");
+		LOG_DEBUG("While stmt");
 		return true;
 	}
 	else if(isReturnStmt()) {
-		Logger::getInstance().debug("Return stmt");
+		LOG_DEBUG("Return stmt");
 		return true;
 	}
 	else if(isFunDecl()) {
 		stmts.push_back(new AstFunStmt(decls.back()->loc, (AstFunDecl*)decls.back()));
 		decls.pop_back();
-		Logger::getInstance().debug("Fun decl stmt");
+		LOG_DEBUG("Fun decl stmt");
 		return true;
 	}
 	else if(isVarDecl()) {
 		stmts.push_back(new AstVarStmt(decls.back()->loc, *(AstVarDecl*)decls.back()));
 		delete decls.back();
 		decls.pop_back();
-		Logger::getInstance().debug("Var decl stmt");
+		LOG_DEBUG("Var decl stmt");
 		return true;
 	}
 	else if(isExprStmt()) {
-		Logger::getInstance().debug("Expr stmt");
+		LOG_DEBUG("Expr stmt");
 		return true;
 	}
 	else if(isCompoundStmt()) {
-		Logger::getInstance().debug("Compound stmt");
+		LOG_DEBUG("Compound stmt");
 		return true;
 	}
 
@@ -630,7 +685,7 @@ bool Synan::isExprStmt() {
 
 	if(isExpr()) {
 		if(!isTokenType(Token::SEMICOLON)) {
-			Logger::getInstance().error("Syntax error line %d: expected ';'", tokens[pos].getLine());
+			expectedSemicolon();
 			pos = oldPos;
 			return false;
 		}
@@ -656,7 +711,7 @@ bool Synan::isAssignStmt() {
 				AstExpr* right = exprs.back();
 
 				if(!isTokenType(Token::SEMICOLON)) {
-					Logger::getInstance().error("Syntax error line %d: expected ';'", tokens[pos].getLine());
+					expectedSemicolon();
 					pos = oldPos;
 					return false;
 				}
@@ -738,7 +793,7 @@ bool Synan::isReturnStmt() {
 		}
 
 		if(!isTokenType(Token::SEMICOLON)) {
-			Logger::getInstance().error("Syntax error line %d: expected ';'", tokens[pos].getLine());
+			expectedSemicolon();
 			pos = oldPos;
 			return false;
 		}
@@ -752,7 +807,7 @@ bool Synan::isReturnStmt() {
 }
 
 bool Synan::isTokenType(Token::TokenType type) { 
-	// Logger::getInstance().debug("TOKEN[%d]: %d\n", type, pos);
+	// LOG_DEBUG("TOKEN[%d]: %d\n", type, pos);
 	if (tokens[pos].getType() == type) { 
 		pos += 1; 
 		return true;
@@ -760,3 +815,33 @@ bool Synan::isTokenType(Token::TokenType type) {
 
 	return false;
 }
+
+bool Synan::enterNesting() {
+	if(tooDeep)
+		return false;
+
+	// reported once, every enclosing level then fails right away
+	if(nesting == MAX_NESTING) {
+		Diagnostics::error("S003", tokens[pos].getLocation(), "Nested more than %s levels deep", MAX_NESTING);
+		tooDeep = true;
+		return false;
+	}
+
+	nesting++;
+	return true;
+}
+
+bool Synan::Chain::add() {
+	if(synan.tooDeep)
+		return false;
+
+	if(synan.chained == MAX_CHAINED) {
+		Diagnostics::error("S004", synan.tokens[synan.pos - 1].getLocation(), "More than %s operators chained in one expression", MAX_CHAINED);
+		synan.tooDeep = true;
+		return false;
+	}
+
+	synan.chained++;
+	length++;
+	return true;
+}
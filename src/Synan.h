@@ -7,9 +7,41 @@
 
 
 class Synan {
+public:
+	// statements, parentheses and prefix operators inside each other, deeper input is
+	// rejected because every later phase recurses once per level
+	static constexpr int MAX_NESTING = 1024;
+
+	// chains of binary and postfix operators are parsed in a loop, but later phases still
+	// recurse once per operator, so the operators of all chains an expression is inside of count
+	static constexpr int MAX_CHAINED = 10000;
+
 private:
 	const std::vector<Token>& tokens;
 	int pos = 0;							// current token position
+	int nesting = 0;
+	int chained = 0;
+	bool tooDeep = false;					// MAX_NESTING or MAX_CHAINED was exceeded, the parse fails
+
+	// one level of nesting for as long as it lives, entered is false past MAX_NESTING
+	struct Nested {
+		Synan& synan;
+		bool entered;
+
+		Nested(Synan& synan) : synan(synan), entered(synan.enterNesting()) {}
+		~Nested() { if(entered) synan.nesting--; }
+	};
+
+	// the operators of one chain for as long as it lives
+	struct Chain {
+		Synan& synan;
+		int length = 0;
+
+		Chain(Synan& synan) : synan(synan) {}
+		~Chain() { synan.chained -= length; }
+
+		bool add();		// false past MAX_CHAINED
+	};
 	AstFunDecl* currentFunction = nullptr;	// current function
 
 	std::vector<AstDecl*> decls;
@@ -23,12 +55,20 @@ public:
 
 	~Synan();
 	bool parse();
-	void printDecls();
+	void printDecls(std::ostream& out);
 
 	std::vector<AstDecl*>& getDecls() {
 		return decls;
 	}
 
+	std::vector<AstExpr*>& getExprs() {
+		return exprs;
+	}
+
+	size_t getNodeCount() const {
+		return decls.size() + types.size() + exprs.size() + stmts.size();
+	}
+
 private:
 	bool isDecl();
 	bool isVarDecl();
@@ -47,6 +87,7 @@ private:
 	bool isVariableAccess();
 	bool isFunctionCall();
 	bool isEnclosedExpr();
+	bool isSizeofExpr();
 	bool isInPlaceExpr();
 	bool isInfixExpr();
 
@@ -75,4 +116,6 @@ private:
 	bool isReturnStmt();
 
 	bool isTokenType(Token::TokenType type);
+	bool enterNesting();
+	void expectedSemicolon();
 };
@@ -0,0 +1,136 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iterator>
+#include "Trace.h"
+
+thread_local int ThreadPool::self = -1;
+
+ThreadPool::ThreadPool(unsigned threads) {
+	for(unsigned i = 1; i < threads; i++) {
+		queues.emplace_back(new Queue());
+	}
+
+	for(unsigned i = 1; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::work, this, i - 1);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for(std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+	if(count == 0) {
+		return;
+	}
+
+	if(count == 1 || workers.empty()) {
+		for(size_t i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	Job job;
+	job.task = &task;
+	job.remaining = count;
+
+	// a worker keeps its tasks local and lets the others steal them,
+	// an outside thread spreads them over all queues
+	pending += count;
+	for(size_t i = 0; i < count; i++) {
+		size_t index = self >= 0 ? self : nextQueue++ % queues.size();
+		Queue& queue = *queues[index];
+
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks.push_back({ &job, i });
+	}
+
+	{
+		// notifying under the lock so a thread about to sleep cannot miss the new tasks
+		std::lock_guard<std::mutex> guard(lock);
+		wake.notify_all();
+	}
+
+	// no task of this job is queued after this, the rest are already running elsewhere
+	while(runOne(&job)) {}
+
+	std::unique_lock<std::mutex> guard(lock);
+	finished.wait(guard, [&job] { return job.remaining == 0; });
+}
+
+bool ThreadPool::pop(Queue& queue, bool own, const Job* only, Task& task) {
+	std::lock_guard<std::mutex> guard(queue.lock);
+	auto matches = [only](const Task& queued) { return only == nullptr || queued.job == only; };
+
+	// the tasks of a job a worker waits for are at the back of its own queue
+	std::deque<Task>::iterator it;
+	if(own) {
+		auto last = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), matches);
+		it = last == queue.tasks.rend() ? queue.tasks.end() : std::prev(last.base());
+	}
+	else {
+		it = std::find_if(queue.tasks.begin(), queue.tasks.end(), matches);
+	}
+
+	if(it == queue.tasks.end()) {
+		return false;
+	}
+
+	task = *it;
+	queue.tasks.erase(it);
+
+	// counted down together with the pop, so sleeping workers never wait on a task that is gone
+	pending--;
+	return true;
+}
+
+bool ThreadPool::runOne(const Job* only) {
+	Task task;
+	bool found = self >= 0 && pop(*queues[self], true, only, task);
+
+	for(size_t i = 1; !found && i <= queues.size(); i++) {
+		size_t victim = (self + i) % queues.size();
+		found = pop(*queues[victim], false, only, task);
+	}
+
+	if(!found) {
+		return false;
+	}
+
+	Job* job = task.job;
+	(*job->task)(task.index);
+
+	// the job lives on its caller's stack, it must not be touched after the last task
+	if(--job->remaining == 0) {
+		std::lock_guard<std::mutex> guard(lock);
+		finished.notify_all();
+	}
+	return true;
+}
+
+void ThreadPool::work(int index) {
+	self = index;
+	Trace::setThreadName("worker " + std::to_string(index));
+
+	while(true) {
+		if(runOne()) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(lock);
+		wake.wait(guard, [this] { return stopping || pending > 0; });
+
+		if(stopping) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Work-stealing pool: every worker owns a deque, takes its own newest task first and
+// steals the oldest task of another worker when it runs dry. A thread waiting in
+// parallelFor only runs tasks of its own batch and then sleeps until the rest are
+// done, so tasks may use the pool themselves and a short wait never ends up running
+// unrelated long work.
+class ThreadPool {
+private:
+	struct Job {
+		const std::function<void(size_t)>* task;
+		std::atomic<size_t> remaining;
+	};
+
+	struct Task {
+		Job* job;
+		size_t index;
+	};
+
+	struct Queue {
+		std::mutex lock;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<Queue>> queues;	// one per worker
+	std::atomic<size_t> pending { 0 };			// queued, not yet started tasks
+	std::atomic<size_t> nextQueue { 0 };		// round robin for threads outside the pool
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	bool stopping = false;
+
+	static thread_local int self;	// queue of the current worker, -1 outside the pool
+
+	ThreadPool(unsigned threads);
+
+	void work(int index);
+	bool runOne(const Job* only = nullptr);		// only: run tasks of this job alone
+	bool pop(Queue& queue, bool own, const Job* only, Task& task);
+public:
+	static ThreadPool& getInstance() {
+		static ThreadPool instance(std::thread::hardware_concurrency());
+		return instance;
+	}
+
+	~ThreadPool();
+
+	// runs task(0) .. task(count - 1), the calling thread helps until all are done
+	void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	size_t size() const { return workers.size() + 1; }
+};
@@ -0,0 +1,93 @@
+#include "Timer.h"
+#include "Logger.h"
+
+void TimeReport::add(const Phase& phase) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	for(Phase& other : phases) {
+		if(other.name == phase.name) {
+			other.seconds += phase.seconds;
+			other.items += phase.items;
+			other.symbols += phase.symbols;
+			if(other.unit.empty()) {
+				other.unit = phase.unit;
+			}
+			return;
+		}
+	}
+
+	phases.push_back(phase);
+}
+
+void TimeReport::reset(Format format) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	this->format = format;
+	phases.clear();
+	wall = -1;
+}
+
+std::string TimeReport::wallString(const char* format) {
+	if(wall < 0) {
+		return "";
+	}
+
+	char text[64];
+	snprintf(text, sizeof(text), format, wall * 1000);
+	return text;
+}
+
+void TimeReport::print() {
+	double total = 0;
+	for(const Phase& phase : phases) {
+		total += phase.seconds;
+	}
+
+	if(format == TEXT) {
+		printText(total);
+	}
+	else if(format == JSON) {
+		printJson(total);
+	}
+}
+
+void TimeReport::printText(double total) {
+	Logger& logger = Logger::getInstance();
+
+	logger.log("#i#grnTime report#r\n");
+	logger.log("%-24s %12s %8s %22s %10s", "phase", "wall (ms)", "share", "throughput", "symbols");
+
+	for(const Phase& phase : phases) {
+		std::string throughput = "-";
+		if(phase.items > 0 && phase.seconds > 0) {
+			throughput = std::to_string((size_t)(phase.items / phase.seconds)) + " " + phase.unit + "/s";
+		}
+
+		std::string symbols = phase.symbols > 0 ? std::to_string(phase.symbols) : "-";
+		double share = total > 0 ? 100 * phase.seconds / total : 0;
+
+		logger.log("%-24s %12.3f %7.1f%% %22s %10s", phase.name.c_str(), phase.seconds * 1000, share, throughput.c_str(), symbols.c_str());
+	}
+
+	logger.log("%-24s %12.3f%s", "total", total * 1000, wallString(" (wall %.3f ms)").c_str());
+}
+
+void TimeReport::printJson(double total) {
+	std::string json = "{\"phases\": [";
+
+	for(size_t i = 0; i < phases.size(); i++) {
+		const Phase& phase = phases[i];
+		double rate = phase.seconds > 0 ? phase.items / phase.seconds : 0;
+
+		json += (i == 0) ? "\n" : ",\n";
+		json += "  {\"name\": \"" + phase.name + "\"";
+		json += ", \"wall_ms\": " + std::to_string(phase.seconds * 1000);
+		json += ", \"items\": " + std::to_string(phase.items);
+		json += ", \"unit\": \"" + phase.unit + "\"";
+		json += ", \"per_second\": " + std::to_string(rate);
+		json += ", \"symbols\": " + std::to_string(phase.symbols) + "}";
+	}
+
+	json += "\n], \"total_ms\": " + std::to_string(total * 1000) + wallString(", \"wall_ms\": %f") + "}\n";
+	Logger::getInstance().write(json);
+}
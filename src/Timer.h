@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include "Trace.h"
+
+// Collects per-phase wall times for -ftime-report. While disabled no clock is read
+// and nothing is recorded. Phases with the same name, e.g. from several input files,
+// are summed up, so with parallel compilation their total may exceed the wall time.
+class TimeReport {
+public:
+	enum Format {
+		NONE,
+		TEXT,
+		JSON
+	};
+
+	struct Phase {
+		std::string name;
+		double seconds;
+		size_t items;			// tokens, nodes, ... processed by the phase
+		std::string unit;
+		size_t symbols;
+	};
+
+private:
+	Format format = NONE;
+	std::vector<Phase> phases;
+	double wall = -1;		// whole run, if known
+	std::mutex lock;
+
+	TimeReport() {}
+
+	void printText(double total);
+	void printJson(double total);
+	std::string wallString(const char* format);
+
+public:
+	static TimeReport& getInstance() {
+		static TimeReport instance;
+		return instance;
+	}
+
+	void reset(Format format);	// drops everything recorded so far
+	bool isEnabled() const { return format != NONE; }
+
+	void add(const Phase& phase);
+	void setWall(double seconds) { wall = seconds; }
+	void print();
+};
+
+// Times the enclosing scope and records it as one phase of the report, and of the trace
+class ScopedTimer {
+private:
+	TraceScope trace;
+	bool enabled;
+	TimeReport::Phase phase;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	ScopedTimer(const char* name) : trace(name), enabled(TimeReport::getInstance().isEnabled()) {
+		if(enabled) {
+			phase = { name, 0, 0, "", 0 };
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedTimer() {
+		if(enabled) {
+			phase.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			TimeReport::getInstance().add(phase);
+		}
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	void count(size_t items, const char* unit) {
+		if(enabled) {
+			phase.items = items;
+			phase.unit = unit;
+		}
+	}
+
+	void symbols(size_t count) {
+		if(enabled) {
+			phase.symbols = count;
+		}
+	}
+};
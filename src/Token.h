@@ -95,9 +95,10 @@ public:
 	int getLine() const { return location.line; }
 	int getStart() const { return location.start; }
 	int getEnd() const { return location.end; }
+	const Location& getLocation() const { return location; }
 	std::string getText() const { return text; }
 
-	std::string getName() const { return tokenNames[(int)type]; }
+	const std::string& getName() const { return tokenNames[(int)type]; }
 
 	friend std::ostream& operator<<(std::ostream& os, const Token& token) {
 		os << token.getName() << "(" << token.location.start << "," << token.location.end <<  ")";
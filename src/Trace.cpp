@@ -0,0 +1,132 @@
+#include "Trace.h"
+#include <fstream>
+#include <cstring>
+
+std::atomic<bool> Trace::enabled { false };
+thread_local Trace::Buffer* Trace::local = nullptr;
+
+// kept apart from the buffer, which is only allocated once the thread records something
+static thread_local std::string threadName;
+
+Trace::Buffer& Trace::buffer() {
+	if(local) {
+		return *local;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	buffers.emplace_back(new Buffer());
+	local = buffers.back().get();
+	local->events.resize(BUFFER_EVENTS);
+	local->id = buffers.size();
+	local->thread = threadName.empty() ? "thread " + std::to_string(local->id) : threadName;
+
+	return *local;
+}
+
+void Trace::setThreadName(const std::string& name) {
+	threadName = name;
+
+	if(local) {
+		local->thread = name;
+	}
+}
+
+void Trace::start() {
+	std::lock_guard<std::mutex> guard(lock);
+
+	for(auto& buffer : buffers) {
+		buffer->next = 0;
+		buffer->wrapped = false;
+	}
+
+	epoch = std::chrono::steady_clock::now();
+	enabled = true;
+}
+
+int64_t Trace::now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, const char* detail, int64_t start, int64_t end) {
+	Buffer& buffer = this->buffer();
+	Event& event = buffer.events[buffer.next];
+
+	event.name = name;
+	strncpy(event.detail, detail, DETAIL_SIZE - 1);
+	event.detail[DETAIL_SIZE - 1] = '\0';
+	event.start = start;
+	event.duration = end - start;
+
+	if(++buffer.next == buffer.events.size()) {
+		buffer.next = 0;
+		buffer.wrapped = true;
+	}
+}
+
+static std::string escape(const char* text) {
+	std::string escaped;
+
+	for(; *text; text++) {
+		if(*text == '"' || *text == '\\') {
+			escaped += '\\';
+			escaped += *text;
+		}
+		else if((unsigned char)*text < 0x20) {
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", *text);
+			escaped += code;
+		}
+		else {
+			escaped += *text;
+		}
+	}
+
+	return escaped;
+}
+
+bool Trace::write(const std::string& path) {
+	enabled = false;
+
+	std::ofstream file(path);
+	if(!file) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	bool first = true;
+	char text[128];
+
+	auto add = [&](const std::string& event) {
+		json += first ? "\n" : ",\n";
+		json += event;
+		first = false;
+	};
+
+	for(auto& buffer : buffers) {
+		add("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " + std::to_string(buffer->id)
+			+ ", \"args\": {\"name\": \"" + escape(buffer->thread.c_str()) + "\"}}");
+
+		// oldest first, a wrapped buffer continues behind its next slot
+		size_t count = buffer->wrapped ? buffer->events.size() : buffer->next;
+		size_t begin = buffer->wrapped ? buffer->next : 0;
+
+		for(size_t i = 0; i < count; i++) {
+			const Event& event = buffer->events[(begin + i) % buffer->events.size()];
+
+			snprintf(text, sizeof(text), "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d", event.start / 1000.0, event.duration / 1000.0, buffer->id);
+			std::string line = "{\"name\": \"" + escape(event.name) + "\", \"cat\": \"compiler\", \"ph\": \"X\", " + text;
+
+			if(event.detail[0] != '\0') {
+				line += ", \"args\": {\"detail\": \"" + escape(event.detail) + "\"}";
+			}
+			add(line + "}");
+		}
+	}
+
+	json += "\n]}\n";
+	file << json;
+
+	return (bool)file;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Timeline of a run for --trace, written in the Chrome trace event format that
+// chrome://tracing and Perfetto load. Every thread records complete events into its own
+// ring buffer, so recording takes no lock, and only the newest events of a thread are
+// kept if it records more than fit. While disabled a scope costs a single branch.
+//
+// Buffers are read without synchronizing with their threads, so start() and write()
+// may only be called while no pool work is running, e.g. by the driver before and after
+// its parallelFor.
+class Trace {
+public:
+	static const size_t DETAIL_SIZE = 40;
+
+	struct Event {
+		const char* name;			// string literal
+		char detail[DETAIL_SIZE];	// e.g. the file or declaration, cut to fit
+		int64_t start;				// ns since start()
+		int64_t duration;
+	};
+
+private:
+	static const size_t BUFFER_EVENTS = 1 << 15;
+
+	struct Buffer {
+		std::vector<Event> events;
+		size_t next = 0;			// slot of the next event
+		bool wrapped = false;		// older events have been overwritten
+		int id;
+		std::string thread;
+	};
+
+	static std::atomic<bool> enabled;
+	static thread_local Buffer* local;
+
+	std::vector<std::unique_ptr<Buffer>> buffers;
+	std::mutex lock;
+	std::chrono::steady_clock::time_point epoch;
+
+	Trace() {}
+
+	Buffer& buffer();
+
+public:
+	static Trace& getInstance() {
+		static Trace instance;
+		return instance;
+	}
+
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	void start();							// drops earlier events and starts recording
+	bool write(const std::string& path);	// stops recording, false if path can't be written
+
+	int64_t now() const;
+	void record(const char* name, const char* detail, int64_t start, int64_t end);
+
+	// shown as the name of the calling thread's track
+	static void setThreadName(const std::string& name);
+};
+
+// Records the enclosing scope as one event
+class TraceScope {
+private:
+	const char* name;
+	const char* detail;
+	int64_t start;
+
+public:
+	TraceScope(const char* name, const char* detail = "") : name(Trace::isEnabled() ? name : nullptr), detail(detail) {
+		if(this->name) {
+			start = Trace::getInstance().now();
+		}
+	}
+
+	~TraceScope() {
+		if(name) {
+			Trace::getInstance().record(name, detail, start, Trace::getInstance().now());
+		}
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+	// for details only known at the end of the scope, must outlive it
+	void setDetail(const char* detail) { this->detail = detail; }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
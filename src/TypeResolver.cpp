@@ -1,10 +1,14 @@
 #include "TypeResolver.h"
 #include "Ast.h"
 #include "Logger.h"
+#include "Diagnostics.h"
+#include "Layout.h"
+#include "ConstFolder.h"
+#include "OperatorTable.h"
 
 bool TypeResolver::resolvePtrOrArrType(AstType* left, AstType* right) {
 	while(true) {
-		// Logger::getInstance().debug("%s %s", left->toString().c_str(), right->toString().c_str());
+		// LOG_DEBUG("%s %s", left->toString().c_str(), right->toString().c_str());
 		if(left->type != right->type) {
 			return false;
 		}
@@ -27,6 +31,11 @@ bool TypeResolver::resolvePtrOrArrType(AstType* left, AstType* right) {
 
 
 bool TypeResolver::visit(AstVarDecl* varDecl, Phase phase) {
+	// declarations other than function bodies are all resolved in HEAD
+	if(phase == Phase::BODY) {
+		return true;
+	}
+
 	if(!varDecl->type->accept(this, phase)) {
 		return false;
 	}
@@ -37,7 +46,7 @@ bool TypeResolver::visit(AstVarDecl* varDecl, Phase phase) {
 
 	if(varDecl->expr) {
 		if(varDecl->type->type != varDecl->expr->ofType->type) {
-			Logger::getInstance().error("Type error: Type mismatch at variable declaration %s%s!", varDecl->name.c_str(), varDecl->loc.toString().c_str());
+			Diagnostics::error("T001", varDecl->loc, "Type mismatch at variable declaration %s", varDecl->name);
 			return false;
 		}
 
@@ -45,7 +54,7 @@ bool TypeResolver::visit(AstVarDecl* varDecl, Phase phase) {
 			AstType* left = varDecl->type;
 			AstType* right =varDecl->expr->ofType;
 			if(!resolvePtrOrArrType(left, right)) {
-				Logger::getInstance().error("Type error: Pointer type mismatch at variable declaration %s%s!", varDecl->name.c_str(), varDecl->loc.toString().c_str());
+				Diagnostics::error("T002", varDecl->loc, "Pointer type mismatch at variable declaration %s", varDecl->name);
 				return false;
 			}
 		}
@@ -56,34 +65,38 @@ bool TypeResolver::visit(AstVarDecl* varDecl, Phase phase) {
 }
 
 bool TypeResolver::visit(AstParDecl* parDecl, Phase phase) {
+	bool result = true;
+
 	for(AstVarDecl& decl : parDecl->params) {
-		if(!decl.accept(this, phase)) {
-			return false;
-		}
+		result = decl.accept(this, phase) && result;
 	}
 
-	return true;
+	return result;
 }
 
 bool TypeResolver::visit(AstFunDecl* funDecl, Phase phase) {
-	if(!funDecl->type->accept(this, phase)) {
-		return false;
-	}
-
-	if(funDecl->type->type == AstType::VOID)
-		funDecl->hasReturn = true;
+	// HEAD resolves the signature, BODY checks the body against it
+	if(phase == Phase::HEAD) {
+		if(!funDecl->type->accept(this, phase)) {
+			return false;
+		}
 
-	if(funDecl->params && !funDecl->params->accept(this, phase)) {
-		return false;
-	}
+		if(funDecl->type->type == AstType::VOID)
+			funDecl->hasReturn = true;
 
-	if(funDecl->body && !funDecl->body->accept(this, phase)) {
-		return false;
+		if(funDecl->params && !funDecl->params->accept(this, phase)) {
+			return false;
+		}
 	}
+	else {
+		if(funDecl->body && !funDecl->body->accept(this, phase)) {
+			return false;
+		}
 
-	if(!funDecl->hasReturn) {
-		Logger::getInstance().error("Type error: Function %s%s does not have return statement!", funDecl->name.c_str(), funDecl->loc.toString().c_str());
-		return false;
+		if(!funDecl->hasReturn) {
+			Diagnostics::error("T003", funDecl->loc, "Function %s does not have return statement", funDecl->name);
+			return false;
+		}
 	}
 
 	return true;
@@ -95,12 +108,22 @@ bool TypeResolver::visit(AstTypeDecl* typeDecl, Phase phase) {
 }
 
 bool TypeResolver::visit(AstStructDecl* structDecl, Phase phase) {
-	std::string name = structDecl->name;
+	if(phase == Phase::BODY) {
+		return true;
+	}
 	
+	bool result = true;
 	for(AstVarDecl& decl : structDecl->fields) {
-		if(!decl.accept(this, phase)) {
-			return false;
-		}
+		result = decl.accept(this, phase) && result;
+	}
+
+	if(!result) {
+		// the body pass must not try to lay it out, it runs on several threads
+		structDecl->layoutFailed = structDecl->size < 0;
+		return false;
+	}
+	if(!Layout::layoutStruct(structDecl)) {
+		return false;
 	}
 
 	Logger::getInstance().log("Type resolved: %s%s!", structDecl->prettyToString().c_str(), structDecl->loc.toString().c_str());
@@ -121,10 +144,26 @@ bool TypeResolver::visit(AstPtrType* ptrType, Phase phase) {
 }
 
 bool TypeResolver::visit(AstArrayType* arrayType, Phase phase) {
+	if(!arrayType->arrayType->accept(this, phase)) {
+		return false;
+	}
+
 	if(!arrayType->expr->accept(this, phase)) {
 		return false;
 	}
 
+	ConstValue value;
+	if(arrayType->expr->ofType->type != AstType::INT || !ConstFolder::evaluate(arrayType->expr, value)) {
+		Diagnostics::error("T004", arrayType->loc, "Array size must be a constant int expression %s", arrayType->expr->toString());
+		return false;
+	}
+
+	if(value.ivalue <= 0) {
+		Diagnostics::error("T005", arrayType->loc, "Array size must be positive, got %s", value.ivalue);
+		return false;
+	}
+
+	arrayType->size = value.ivalue;
 	return true;
 }
 
@@ -141,14 +180,14 @@ bool TypeResolver::visit(AstConstExpr* constExpr, Phase phase) {
 		type = AstType::FLOAT;
 	} else if(constExpr->type == Token::STRING) {
 		type = AstType::CHAR;
-		constExpr->ofType = new AstPtrType(constExpr->loc, new AstAtomType(constExpr->loc, type));
+		constExpr->ofType = new AstPtrType(constExpr->loc, AstAtomType::canonical(type));
 		return true;
 	} else {
-		Logger::getInstance().error("Type error: Unknown constant type %s%s!", constExpr->toString().c_str(), constExpr->loc.toString().c_str());
+		Diagnostics::error("T006", constExpr->loc, "Unknown constant type %s", constExpr->toString());
 		return false;
 	} 
 
-	constExpr->ofType = new AstAtomType(constExpr->loc, type);
+	constExpr->ofType = AstAtomType::canonical(type);
 
 	// Logger::getInstance().log("Type resolved: %s", constExpr->toString().c_str());
 	return true;
@@ -163,29 +202,33 @@ bool TypeResolver::visit(AstNamedExpr* namedExpr, Phase phase) {
 }
 
 bool TypeResolver::visit(AstCallExpr* callExpr, Phase phase) {
+	bool result = true;
 	for(AstExpr* expr : callExpr->args) {
-		if(!expr->accept(this, phase))
-			return false;
+		result = expr->accept(this, phase) && result;
+	}
+
+	if(!result) {
+		return false;
 	}
 
 	AstFunDecl* decl = (AstFunDecl*)callExpr->declaration;
 
 	if(decl->params) {
 		if(decl->params->size() != callExpr->args.size()) {
-			Logger::getInstance().error("Type error: Function %s expects %d arguments, but %d were given %s!", decl->name.c_str(), decl->params->size(), callExpr->args.size(), callExpr->loc.toString().c_str());
+			Diagnostics::error("T007", callExpr->loc, "Function %s expects %s arguments, but %s were given", decl->name, decl->params->size(), callExpr->args.size());
 			return false;
 		}
 		
 		for(int i = 0; i < decl->params->size(); i++) {
 			if(decl->params->params[i].type->type != callExpr->args[i]->ofType->type) {
-				Logger::getInstance().error("Type error: Function %s was given invalid argument %s%s!", decl->name.c_str(), decl->params->params[i].name.c_str(), callExpr->loc.toString().c_str());
+				Diagnostics::error("T008", callExpr->loc, "Function %s was given invalid argument %s", decl->name, decl->params->params[i].name);
 				return false;
 			}
 		}
 	}
 	else {
 		if(callExpr->args.size() > 0) {
-			Logger::getInstance().error("Type error: Function %s expects no arguments, but %d were given%s!", decl->name.c_str(), callExpr->args.size(), callExpr->loc.toString().c_str());
+			Diagnostics::error("T009", callExpr->loc, "Function %s expects no arguments, but %s were given", decl->name, callExpr->args.size());
 			return false;
 		}
 	}
@@ -202,11 +245,11 @@ bool TypeResolver::visit(AstCastExpr* castExpr, Phase phase) {
 	}
 
 	if(castExpr->type->type == AstType::VOID) {
-		Logger::getInstance().error("Type error: Cannot cast to void %s%s!", castExpr->toString().c_str(), castExpr->loc.toString().c_str());
+		Diagnostics::error("T010", castExpr->loc, "Cannot cast to void %s", castExpr->toString());
 		return false;
 	}
 	else if(castExpr->expr->ofType->type == AstType::VOID) {
-		Logger::getInstance().error("Type error: Cannot cast from void %s%s!", castExpr->toString().c_str(), castExpr->loc.toString().c_str());
+		Diagnostics::error("T011", castExpr->loc, "Cannot cast from void %s", castExpr->toString());
 		return false;
 	}
 
@@ -241,7 +284,7 @@ bool TypeResolver::visit(AstPrefixExpr* prefixExpr, Phase phase) {
 				prefixExpr->ofType = prefixExpr->expr->ofType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Invalid type for prefix operator (only int, float) %s%s!", prefixExpr->toString().c_str(), prefixExpr->loc.toString().c_str());
+				Diagnostics::error("T012", prefixExpr->loc, "Invalid type for prefix operator (only int, float) %s", prefixExpr->toString());
 				return false;
 			}
 			break;
@@ -250,7 +293,7 @@ bool TypeResolver::visit(AstPrefixExpr* prefixExpr, Phase phase) {
 				prefixExpr->ofType = prefixExpr->expr->ofType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Invalid type for prefix operator (only bool) %s%s!", prefixExpr->toString().c_str(), prefixExpr->loc.toString().c_str());
+				Diagnostics::error("T013", prefixExpr->loc, "Invalid type for prefix operator (only bool) %s", prefixExpr->toString());
 				return false;
 			}
 			break;
@@ -259,7 +302,7 @@ bool TypeResolver::visit(AstPrefixExpr* prefixExpr, Phase phase) {
 				prefixExpr->ofType = ((AstPtrType*)prefixExpr->expr->ofType)->ptrType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Type must be of pointer type %s%s!", prefixExpr->toString().c_str(), prefixExpr->loc.toString().c_str());
+				Diagnostics::error("T014", prefixExpr->loc, "Type must be of pointer type %s", prefixExpr->toString());
 				return false;
 			}
 			break;
@@ -271,7 +314,7 @@ bool TypeResolver::visit(AstPrefixExpr* prefixExpr, Phase phase) {
 				prefixExpr->ofType = prefixExpr->expr->ofType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Invalid type for prefix operator (only int) %s%s!", prefixExpr->toString().c_str(), prefixExpr->loc.toString().c_str());
+				Diagnostics::error("T015", prefixExpr->loc, "Invalid type for prefix operator (only int) %s", prefixExpr->toString());
 				return false;
 			}
 			break;
@@ -303,72 +346,51 @@ bool TypeResolver::visit(AstPostfixExpr* postfixExpr, Phase phase) {
 				postfixExpr->ofType = postfixExpr->expr->ofType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Invalid type for postfix operator %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
+				Diagnostics::error("T016", postfixExpr->loc, "Invalid type for postfix operator %s", postfixExpr->toString());
 				return false;
 			}
 			break;
 		case AstPostfixExpr::ACCESS: // id.id
-			if(postfixExpr->expr->ofType->type == AstType::NAMED) {
-				AstNamedType* namedType = (AstNamedType*)postfixExpr->expr->ofType;
-				AstStructDecl* declaration = (AstStructDecl*)namedType->declaration;
-
-				bool flag = false;
-				for(AstVarDecl& field : declaration->fields) {
-					if(field.name == postfixExpr->name) {
-						postfixExpr->ofType = field.type;
-						flag = true;
-						break;
-					}
-				}
-				
-				if(!flag) {
-					Logger::getInstance().error("Type error: Struct %s doesn't have field with name %s%s!", namedType->name.c_str(), postfixExpr->name.c_str(), postfixExpr->loc.toString().c_str());
+		case AstPostfixExpr::PTRACCESS: { // id->id
+			AstType* structType = postfixExpr->expr->ofType;
+
+			if(postfixExpr->op == AstPostfixExpr::PTRACCESS) {
+				if(structType->type != AstType::PTR) {
+					Diagnostics::error("T017", postfixExpr->loc, "Trying to access non-pointer struct with -> %s", postfixExpr->toString());
 					return false;
 				}
+				structType = ((AstPtrType*)structType)->ptrType;
 			}
-			else {
-				Logger::getInstance().error("Type error: How did you get here? %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
+
+			AstStructDecl* declaration = Layout::structOf(structType);
+			if(declaration == nullptr) {
+				Diagnostics::error("T018", postfixExpr->loc, "Trying to access a nonexisting struct element %s", postfixExpr->toString());
 				return false;
 			}
-			break;
-		case AstPostfixExpr::PTRACCESS: // id->id
-			if(postfixExpr->expr->ofType->type == AstType::PTR) {
-				AstPtrType* ptrType = (AstPtrType*)postfixExpr->expr->ofType;
-
-				if(ptrType->ptrType->type == AstType::NAMED) {
-					AstNamedType* namedType = (AstNamedType*)ptrType->ptrType;
-					AstStructDecl* declaration = (AstStructDecl*)namedType->declaration;
-					bool flag = false;
-					for(AstVarDecl& field : declaration->fields) {
-						if(field.name == postfixExpr->name) {
-							postfixExpr->ofType = field.type;
-							flag = true;
-							break;
-						}
-					}
-					
-					if(!flag) {
-						Logger::getInstance().error("Type error: Struct %s doesn't have field with name %s%s!", namedType->name.c_str(), postfixExpr->name.c_str(), postfixExpr->loc.toString().c_str());
-						return false;
-					}
-				}
-				else {
-					Logger::getInstance().error("Type error: Trying to access a nonexisting struct element %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
-					return false;
-				}
+
+			// the struct's own error was reported once, where it is declared
+			if(!Layout::layoutStruct(declaration)) {
+				Diagnostics::error("T033", postfixExpr->loc, "Struct %s has no layout, its field %s can't be accessed", declaration->name, postfixExpr->name);
+				return false;
 			}
-			else {
-				Logger::getInstance().error("Type error: Trying to access non-pointer struct with -> %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
+
+			int field = declaration->findField(postfixExpr->name);
+			if(field < 0) {
+				Diagnostics::error("T019", postfixExpr->loc, "Struct %s doesn't have field with name %s", declaration->name, postfixExpr->name);
 				return false;
-			}	
+			}
+
+			postfixExpr->field = field;
+			postfixExpr->ofType = declaration->fields[field].type;
 			break;
+		}
 		case AstPostfixExpr::ARRAYACCESS: // id[id]
 			if(!postfixExpr->index->accept(this, phase)) {
 				return false;
 			}
 
 			if(postfixExpr->index->ofType->type != AstType::INT) {
-				Logger::getInstance().error("Type error: Array index must be of type int %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
+				Diagnostics::error("T020", postfixExpr->loc, "Array index must be of type int %s", postfixExpr->toString());
 				return false;
 			}
 
@@ -379,7 +401,7 @@ bool TypeResolver::visit(AstPostfixExpr* postfixExpr, Phase phase) {
 				postfixExpr->ofType = ((AstPtrType*)postfixExpr->expr->ofType)->ptrType;
 			}
 			else {
-				Logger::getInstance().error("Type error: Invalid array type %s%s!", postfixExpr->toString().c_str(), postfixExpr->loc.toString().c_str());
+				Diagnostics::error("T021", postfixExpr->loc, "Invalid array type %s", postfixExpr->toString());
 				return false;
 			}
 
@@ -390,97 +412,42 @@ bool TypeResolver::visit(AstPostfixExpr* postfixExpr, Phase phase) {
 }
 
 bool TypeResolver::visit(AstBinaryExpr* binaryExpr, Phase phase) {
-	if(!binaryExpr->left->accept(this, phase)) {
+	bool left = binaryExpr->left->accept(this, phase);
+	bool right = binaryExpr->right->accept(this, phase);
+
+	if(!left || !right) {
 		return false;
 	}
 
-	if(!binaryExpr->right->accept(this, phase)) {
+	AstType* leftType = binaryExpr->left->ofType;
+	AstType* rightType = binaryExpr->right->ofType;
+
+	binaryExpr->ofType = OperatorTable::binaryType(binaryExpr->op, leftType, rightType);
+
+	if(binaryExpr->ofType == nullptr || (leftType->type == AstType::PTR && rightType->type == AstType::PTR && !resolvePtrOrArrType(leftType, rightType))) {
+		Diagnostics::error("T022", binaryExpr->loc, "Invalid type for binary operator %s", binaryExpr->toString());
 		return false;
 	}
 
-	switch(binaryExpr->op) {
-		case AstBinaryExpr::PLUS:
-		case AstBinaryExpr::MINUS:
-		case AstBinaryExpr::MUL:
-		case AstBinaryExpr::DIV:
-		case AstBinaryExpr::MOD:
-			if(binaryExpr->left->ofType->type == AstType::INT && binaryExpr->right->ofType->type == AstType::INT) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else if(binaryExpr->left->ofType->type == AstType::FLOAT && binaryExpr->right->ofType->type == AstType::FLOAT) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else if(binaryExpr->left->ofType->type == AstType::PTR && binaryExpr->right->ofType->type == AstType::INT) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else if(binaryExpr->left->ofType->type == AstType::INT && binaryExpr->right->ofType->type == AstType::PTR) {
-				binaryExpr->ofType = binaryExpr->right->ofType;
-			}
-			else if(binaryExpr->left->ofType->type == AstType::CHAR && binaryExpr->right->ofType->type == AstType::INT) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else if(binaryExpr->left->ofType->type == AstType::INT && binaryExpr->right->ofType->type == AstType::CHAR) {
-				binaryExpr->ofType = binaryExpr->right->ofType;
-			}
-			else {
-				Logger::getInstance().error("Type error: Invalid type for binary operator %s%s!", binaryExpr->toString().c_str(), binaryExpr->loc.toString().c_str());
-				return false;
-			}
-			break;
-		case AstBinaryExpr::EQU:
-		case AstBinaryExpr::NEQ:
-		case AstBinaryExpr::LESS:
-		case AstBinaryExpr::LESS_EQU:
-		case AstBinaryExpr::GREATER:
-		case AstBinaryExpr::GREATER_EQU:
-			if(binaryExpr->left->ofType->type == AstType::INT && binaryExpr->right->ofType->type == AstType::INT) {
-				binaryExpr->ofType = new AstAtomType(binaryExpr->loc, AstAtomType::BOOL);
-			}
-			else if(binaryExpr->left->ofType->type == AstType::FLOAT && binaryExpr->right->ofType->type == AstType::FLOAT) {
-				binaryExpr->ofType = new AstAtomType(binaryExpr->loc, AstAtomType::BOOL);
-			}
-			else if(binaryExpr->left->ofType->type == AstType::PTR && binaryExpr->right->ofType->type == AstType::PTR) {
-				if(!resolvePtrOrArrType(binaryExpr->left->ofType, binaryExpr->right->ofType)) {
-					Logger::getInstance().error("Type error: Invalid type for binary operator %s%s!", binaryExpr->toString().c_str(), binaryExpr->loc.toString().c_str());
-					return false;
-				}
-				binaryExpr->ofType = new AstAtomType(binaryExpr->loc, AstAtomType::BOOL);
-			}
-			else if(binaryExpr->left->ofType->type == AstType::CHAR && binaryExpr->right->ofType->type == AstType::CHAR) {
-				binaryExpr->ofType = new AstAtomType(binaryExpr->loc, AstAtomType::BOOL);
-			}
-			else {
-				Logger::getInstance().error("Type error: Invalid type for binary operator %s%s!", binaryExpr->toString().c_str(), binaryExpr->loc.toString().c_str());
-				return false;
-			}
-			break;
-		case AstBinaryExpr::AND:
-		case AstBinaryExpr::OR:
-		case AstBinaryExpr::XOR:
-			if(binaryExpr->left->ofType->type == AstType::INT && binaryExpr->right->ofType->type == AstType::INT) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else {
-				Logger::getInstance().error("Type error: Invalid type for binary operator %s%s!", binaryExpr->toString().c_str(), binaryExpr->loc.toString().c_str());
-				return false;
-			}
-			break;
-		case AstBinaryExpr::ANDAND:
-		case AstBinaryExpr::OROR:
-			if(binaryExpr->left->ofType->type == AstType::BOOL && binaryExpr->right->ofType->type == AstType::BOOL) {
-				binaryExpr->ofType = binaryExpr->left->ofType;
-			}
-			else {
-				Logger::getInstance().error("Type error: Invalid type for binary operator %s%s!", binaryExpr->toString().c_str(), binaryExpr->loc.toString().c_str());
-				return false;
-			}
-			break;
-	};
-
 	// Logger::getInstance().log("Type resolved: %s", binaryExpr->toString().c_str());
 	return true;
 }
 
+bool TypeResolver::visit(AstSizeofExpr* sizeofExpr, Phase phase) {
+	if(!sizeofExpr->type->accept(this, phase)) {
+		return false;
+	}
+
+	sizeofExpr->size = Layout::sizeOf(sizeofExpr->type);
+	if(sizeofExpr->size < 0) {
+		Diagnostics::error("T023", sizeofExpr->loc, "Type %s has no known size", sizeofExpr->type->getTypeName());
+		return false;
+	}
+
+	sizeofExpr->ofType = AstAtomType::canonical(AstType::INT);
+	return true;
+}
+
 
 bool TypeResolver::visit(AstExprStmt* exprStmt, Phase phase) {
 	if(!exprStmt->expr->accept(this, phase)) {
@@ -493,24 +460,22 @@ bool TypeResolver::visit(AstExprStmt* exprStmt, Phase phase) {
 
 bool TypeResolver::visit(AstAssignStmt* assignStmt, Phase phase) {
 	// a += 3 -> a must be int and 3 must be int
-	
-	if(!assignStmt->left->accept(this, phase)) {
-		return false;
-	}
+	bool left = assignStmt->left->accept(this, phase);
+	bool right = assignStmt->right->accept(this, phase);
 
-	if(!assignStmt->right->accept(this, phase)) {
+	if(!left || !right) {
 		return false;
 	}
 
 	// left and right must match
 	if(assignStmt->left->ofType->type != assignStmt->right->ofType->type) {
-		Logger::getInstance().error("Type error: Invalid type for assignment %s%s!", assignStmt->toString().c_str(), assignStmt->loc.toString().c_str());
+		Diagnostics::error("T024", assignStmt->loc, "Invalid type for assignment %s", assignStmt->toString());
 		return false;
 	}
 
 	if(assignStmt->left->ofType->type == AstType::PTR || assignStmt->left->ofType->type == AstType::ARRAY) {
 		if(!resolvePtrOrArrType(assignStmt->left->ofType, assignStmt->right->ofType)) {
-			Logger::getInstance().error("Type error: Invalid type for pointer assignment %s%s!", assignStmt->toString().c_str(), assignStmt->loc.toString().c_str());
+			Diagnostics::error("T025", assignStmt->loc, "Invalid type for pointer assignment %s", assignStmt->toString());
 			return false;
 		}
 	}
@@ -518,7 +483,7 @@ bool TypeResolver::visit(AstAssignStmt* assignStmt, Phase phase) {
 	// check for += -= *= /= %=
 	if(assignStmt->op != AstAssignStmt::EQU) {
 		if(assignStmt->left->ofType->type != AstType::INT && assignStmt->left->ofType->type != AstType::FLOAT) {
-			Logger::getInstance().error("Type error: Invalid type for assignment %s%s!", assignStmt->toString().c_str(), assignStmt->loc.toString().c_str());
+			Diagnostics::error("T026", assignStmt->loc, "Compound assignment needs an int or float %s", assignStmt->toString());
 			return false;
 		}
 	}
@@ -528,30 +493,31 @@ bool TypeResolver::visit(AstAssignStmt* assignStmt, Phase phase) {
 }
 
 bool TypeResolver::visit(AstCompStmt* compStmt, Phase phase) {
+	// a statement's error doesn't affect the types of the next ones, so all are checked
+	bool result = true;
+
 	for(AstStmt* stmt : compStmt->stmts) {
-		if(!stmt->accept(this, phase)) {
-			return false;
-		}
+		result = stmt->accept(this, phase) && result;
 	}
 
-	return true;
+	return result;
 }
 
 bool TypeResolver::visit(AstIfStmt* ifStmt, Phase phase) {
-	if(!ifStmt->cond->accept(this, phase)) {
-		return false;
-	}
+	bool result = ifStmt->cond->accept(this, phase);
 
-	if(ifStmt->cond->ofType->type != AstType::BOOL) {
-		Logger::getInstance().error("Type error: Invalid type for if condition %s%s!", ifStmt->cond->toString().c_str(), ifStmt->cond->loc.toString().c_str());
-		return false;
+	if(result && ifStmt->cond->ofType->type != AstType::BOOL) {
+		Diagnostics::error("T027", ifStmt->cond->loc, "Invalid type for if condition %s", ifStmt->cond->toString());
+		result = false;
 	}
 
-	if(!ifStmt->stmt->accept(this, phase)) {
-		return false;
+	result = ifStmt->stmt->accept(this, phase) && result;
+
+	if(ifStmt->elseStmt) {
+		result = ifStmt->elseStmt->accept(this, phase) && result;
 	}
 
-	if(ifStmt->elseStmt && !ifStmt->elseStmt->accept(this, phase)) {
+	if(!result) {
 		return false;
 	}
 
@@ -560,16 +526,14 @@ bool TypeResolver::visit(AstIfStmt* ifStmt, Phase phase) {
 }
 
 bool TypeResolver::visit(AstWhileStmt* whileStmt, Phase phase) {
-	if(!whileStmt->cond->accept(this, phase)) {
-		return false;
-	}
+	bool result = whileStmt->cond->accept(this, phase);
 
-	if(whileStmt->cond->ofType->type != AstType::BOOL) {
-		Logger::getInstance().error("Type error: Invalid type for while condition %s%s!", whileStmt->cond->toString().c_str(), whileStmt->cond->loc.toString().c_str());
-		return false;
+	if(result && whileStmt->cond->ofType->type != AstType::BOOL) {
+		Diagnostics::error("T028", whileStmt->cond->loc, "Invalid type for while condition %s", whileStmt->cond->toString());
+		result = false;
 	}
 
-	if(!whileStmt->stmt->accept(this, phase)) {
+	if(!whileStmt->stmt->accept(this, phase) || !result) {
 		return false;
 	}
 
@@ -584,7 +548,7 @@ bool TypeResolver::visit(AstReturnStmt* returnStmt, Phase phase) {
 
 	if(returnStmt->expr) { // not void
 		if(!resolvePtrOrArrType(returnStmt->expr->ofType, returnStmt->funDecl->type)) {
-			Logger::getInstance().error("Type error: Type mismatch for return in function %s%s!", returnStmt->funDecl->name.c_str(), returnStmt->loc.toString().c_str());
+			Diagnostics::error("T029", returnStmt->loc, "Type mismatch for return in function %s", returnStmt->funDecl->name);
 			return false;
 		}
 
@@ -592,7 +556,7 @@ bool TypeResolver::visit(AstReturnStmt* returnStmt, Phase phase) {
 	}
 	else {	// return void
 		if(returnStmt->funDecl->type->type != AstType::VOID) {
-			Logger::getInstance().error("Type error: Invalid return statement in function %s%s!", returnStmt->funDecl->name.c_str(), returnStmt->loc.toString().c_str());
+			Diagnostics::error("T030", returnStmt->loc, "Invalid return statement in function %s", returnStmt->funDecl->name);
 			return false;
 		}
 
@@ -606,7 +570,7 @@ bool TypeResolver::visit(AstReturnStmt* returnStmt, Phase phase) {
 }
 
 bool TypeResolver::visit(AstVarStmt* varStmt, Phase phase) {
-	if(!varStmt->decl.accept(this, phase)) {
+	if(!varStmt->decl.accept(this, Phase::HEAD)) {
 		return false;
 	}
 
@@ -614,7 +578,11 @@ bool TypeResolver::visit(AstVarStmt* varStmt, Phase phase) {
 }
 
 bool TypeResolver::visit(AstFunStmt* funStmt, Phase phase) {
-	if(!funStmt->decl->accept(this, phase)) {
+	if(!funStmt->decl->accept(this, Phase::HEAD)) {
+		return false;
+	}
+
+	if(!funStmt->decl->accept(this, Phase::BODY)) {
 		return false;
 	}
 
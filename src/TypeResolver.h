@@ -24,6 +24,7 @@ public:
 	bool visit(AstPrefixExpr* prefixExpr, Phase phase) override;
 	bool visit(AstPostfixExpr* postfixExpr, Phase phase) override;
 	bool visit(AstBinaryExpr* binaryExpr, Phase phase) override;
+	bool visit(AstSizeofExpr* sizeofExpr, Phase phase) override;
 
 	bool visit(AstExprStmt* exprStmt, Phase phase) override;
 	bool visit(AstAssignStmt* assignStmt, Phase phase) override;
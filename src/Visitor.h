@@ -15,6 +15,7 @@ class AstNamedType;
 class AstPtrType;
 class AstArrayType;
 
+class AstExpr;
 class AstConstExpr;
 class AstNamedExpr;
 class AstCallExpr;
@@ -22,7 +23,9 @@ class AstCastExpr;
 class AstPrefixExpr;
 class AstPostfixExpr;
 class AstBinaryExpr;
+class AstSizeofExpr;
 
+class AstStmt;
 class AstExprStmt;
 class AstAssignStmt;
 class AstCompStmt;
@@ -64,6 +67,7 @@ public:
 	virtual bool visit(AstPrefixExpr* prefixExpr, Phase phase) = 0;
 	virtual bool visit(AstPostfixExpr* postfixExpr, Phase phase) = 0;
 	virtual bool visit(AstBinaryExpr* binaryExpr, Phase phase) = 0;
+	virtual bool visit(AstSizeofExpr* sizeofExpr, Phase phase) = 0;
 
 	virtual bool visit(AstExprStmt* exprStmt, Phase phase) = 0;
 	virtual bool visit(AstAssignStmt* assignStmt, Phase phase) = 0;
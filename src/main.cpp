@@ -1,31 +1,33 @@
-#include <iostream>
-#include "Lexan.h"
-#include "Synan.h"
-#include "Seman.h"
+#include "Driver.h"
+#include "Server.h"
 #include "Logger.h"
 
-int main() {
-	
-	std::string filename = "file.txt";
-
-	Lexan lexan;
-	if(!lexan.parse(filename))
+int main(int argc, char** argv) {
+	Options options;
+	if(!Driver::parseOptions(argc, argv, options)) {
+		Driver::printUsage(argv[0]);
 		return -1;
+	}
 
-	lexan.printTokens();
-
-	Synan synan(lexan);
-	if(!synan.parse())
-		return -1;
+	if(!options.logFile.empty()) {
+		std::unique_ptr<FileSink> sink(new FileSink(options.logFile));
+		if(!sink->isOpen()) {
+			Logger::getInstance().error("Cannot open log file %s", options.logFile.c_str());
+			return -1;
+		}
+		Logger::getInstance().setSink(std::move(sink));
+	}
 
-	synan.printDecls();
+	if(options.help) {
+		Driver::printUsage(argv[0]);
+		return 0;
+	}
 
-	Seman seman(synan);
-	if(!seman.resolveNames())
-		return -1;
-	
-	if(!seman.resolveTypes())
-		return -1;
+	if(!options.server.empty()) {
+		Server server(options.server);
+		return server.run();
+	}
 
-	return 0;
+	Driver driver(options);
+	return driver.run();
 }
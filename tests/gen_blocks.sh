@@ -0,0 +1,48 @@
+#!/bin/sh
+# Prints a program with <count> sibling or nested blocks, each declaring its own
+# local. Redeclaring the outer locals at the end only passes if every scope closed.
+# A chain is a single flat expression with <count> additions instead.
+#   gen_blocks.sh siblings|nested|chain <count>
+
+if [ $# -ne 2 ] || { [ "$1" != siblings ] && [ "$1" != nested ] && [ "$1" != chain ]; }; then
+	echo "usage: $0 siblings|nested|chain <count>" >&2
+	exit 2
+fi
+
+awk -v shape="$1" -v count="$2" 'BEGIN {
+	if(shape == "chain") {
+		printf "int run(int a) {\n\treturn a"
+		for(i = 1; i <= count; i++) {
+			printf " + 1"
+		}
+		print ";"
+		print "}"
+		exit
+	}
+
+	print "int g = 1;"
+	print "int run(int a) {"
+	print "\tint v0 = a;"
+
+	for(i = 1; i <= count; i++) {
+		if(shape == "siblings") {
+			printf "\t{ int v%d = v0 + g; v0 = v%d; }\n", i, i
+		}
+		else {
+			printf "{ int v%d = v%d + g;\n", i, i - 1
+		}
+	}
+
+	if(shape == "nested") {
+		printf "v0 = v%d;\n", count
+		for(i = 1; i <= count; i++) {
+			printf "}"
+		}
+		print ""
+	}
+
+	# every inner local is out of scope again
+	print "\tint v1 = v0;"
+	print "\treturn v1;"
+	print "}"
+}'
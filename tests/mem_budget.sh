@@ -0,0 +1,50 @@
+#!/bin/sh
+# Memory budget test: compiles a fixed program of 10k sibling blocks through the IR
+# with --mem-report=json and fails if a phase allocates, or the heap peaks, above its
+# budget. Budgets leave about 25% over what the compiler needs today.
+#   mem_budget.sh [compiler]
+
+COMPILER=${1:-bin/main}
+DIR=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+MB=1048576
+
+"$DIR/gen_blocks.sh" siblings 10000 > "$TMP/input.txt"
+
+# one lane, so allocations don't depend on the thread pool
+if ! "$COMPILER" -j1 --check --no-color --stop-after=ir --mem-report=json "$TMP/input.txt" > "$TMP/report.json" 2>&1; then
+	echo "FAIL compiling the budget input"
+	head -5 "$TMP/report.json"
+	exit 1
+fi
+
+# check <name> <bytes> <budget>
+check() {
+	if [ -z "$2" ]; then
+		echo "FAIL $1: missing from the report"
+		failed=1
+	elif [ "$2" -gt "$3" ]; then
+		echo "FAIL $1: $2 bytes, budget $3"
+		failed=1
+	else
+		echo "ok   $1: $2 bytes (budget $3)"
+	fi
+}
+
+# bytes allocated by a phase, from its line of the report
+phase() {
+	grep "\"name\": \"$1\"" "$TMP/report.json" | sed 's/.*"bytes": \([0-9]*\).*/\1/'
+}
+
+check "lexical analysis" "$(phase "lexical analysis")" $((16 * MB))
+check "syntax analysis" "$(phase "syntax analysis")" $((16 * MB))
+check "name resolution" "$(phase "name resolution")" $((17 * MB))
+check "type resolution" "$(phase "type resolution")" $((14 * MB))
+check "ir lowering" "$(phase "ir lowering")" $((14 * MB))
+check "ir optimization" "$(phase "ir optimization")" $((18 * MB))
+check "peak heap" "$(sed -n 's/.*"peak_heap": \([0-9]*\).*/\1/p' "$TMP/report.json")" $((34 * MB))
+
+exit $failed
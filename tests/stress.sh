@@ -0,0 +1,63 @@
+#!/bin/sh
+# Scope stress test: 100k sibling blocks, the deepest nesting the parser accepts, and
+# 100k nested blocks, which have to be rejected with a diagnostic instead of crashing.
+# Long flat operator chains are no nesting and pass up to Synan::MAX_CHAINED.
+#   stress.sh [compiler]
+
+COMPILER=${1:-bin/main}
+DIR=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+# expect <name> <pass|diagnostic code> <files and options>...
+expect() {
+	name=$1
+	result=$2
+	shift 2
+
+	start=$(date +%s%N)
+	timeout 60 "$COMPILER" --check --no-color "$@" > "$TMP/out.txt" 2>&1
+	status=$?
+	ms=$(( ($(date +%s%N) - start) / 1000000 ))
+
+	# failing the compile is fine, crashing (killed by a signal) or timing out never is
+	case $status in
+		0) [ "$result" = pass ] ;;
+		124 | 129 | 13[0-9] | 14[0-9] | 15[0-9]) false ;;
+		*) [ "$result" != pass ] && grep -q "error\[$result\]" "$TMP/out.txt" ;;
+	esac
+
+	if [ $? -eq 0 ]; then
+		echo "ok   $name (${ms} ms)"
+	else
+		echo "FAIL $name: exit status $status, expected $result"
+		head -5 "$TMP/out.txt"
+		failed=1
+	fi
+}
+
+"$DIR/gen_blocks.sh" siblings 100000 > "$TMP/siblings.txt"
+expect "100000 sibling blocks" pass "$TMP/siblings.txt"
+
+# just below Synan::MAX_NESTING, which the function body and every block count against
+"$DIR/gen_blocks.sh" nested 1000 > "$TMP/nested.txt"
+expect "1000 nested blocks" pass "$TMP/nested.txt"
+
+# worker threads have fixed stacks
+expect "1000 nested blocks on pool threads" pass -j4 "$TMP/nested.txt" "$TMP/nested.txt" "$TMP/nested.txt" "$TMP/nested.txt"
+
+# an inner local used after its block closed
+sed 's/^	int v1 = v0;/	int v1 = v2;/' "$TMP/nested.txt" > "$TMP/leak.txt"
+expect "locals go out of scope" N006 "$TMP/leak.txt"
+
+"$DIR/gen_blocks.sh" nested 100000 > "$TMP/deep.txt"
+expect "100000 nested blocks" S003 "$TMP/deep.txt"
+
+"$DIR/gen_blocks.sh" chain 10000 > "$TMP/chain.txt"
+expect "10000 chained additions" pass "$TMP/chain.txt"
+
+"$DIR/gen_blocks.sh" chain 100000 > "$TMP/longchain.txt"
+expect "100000 chained additions" S004 "$TMP/longchain.txt"
+
+exit $failed